@@ -0,0 +1,43 @@
+#pragma once
+
+#include "clusterer.hpp"
+#include "dbscan.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Perilla de precisión del modo aproximado.
+struct ApproxOptions {
+    // Tolerancia relativa: un vecino a distancia entre eps y (1 + rho)·eps puede
+    // contarse o no. Con rho = 0 solo se omiten las distancias que el índice ya
+    // resuelve por celdas y el resultado coincide con el exacto (salvo empates a
+    // distancia casi exactamente eps).
+    double rho = 0.1;
+    // En celdas que cruzan el borde del círculo y tienen más de `muestra` puntos se
+    // mide un subconjunto de ese tamaño y se escala el conteo. 0 = sin muestreo; solo
+    // se aplica con rho > 0.
+    std::size_t muestra = 64;
+};
+
+// DBSCAN rho-aproximado sobre una grilla de lado eps/2:
+//   - Una celda vecina cuya caja queda entera a menos de (1 + rho)·eps del punto
+//     suma todos sus puntos sin medir distancias; una cuya caja queda entera fuera
+//     de eps se descarta. Como la diagonal de una celda es menor que eps, una celda
+//     con más de min_samples puntos hace core a todos los suyos de inmediato.
+//   - Solo las celdas que cruzan el borde se miden punto a punto (o por muestra si
+//     son densas), y el conteo se corta al llegar a min_samples.
+//   - La frontera usa las mismas reglas contra las celdas con algún core.
+// ws.fases.pares cuenta solo las distancias medidas.
+void dbscan_approx(std::vector<Point>& puntos,
+                   double epsilon,
+                   int min_samples,
+                   const ApproxOptions& opciones,
+                   int num_threads,
+                   Workspace& ws);
+
+std::vector<Point> dbscan_approx(const std::string& ruta,
+                                 double epsilon,
+                                 int min_samples,
+                                 const ApproxOptions& opciones,
+                                 int num_threads = 0);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "clusterer.hpp"
+#include "dbscan.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Configuración elegida por --autotune para una máquina. Se guarda como líneas
+// clave=valor; `cpu` identifica el modelo para no aplicar el perfil en otro equipo.
+struct TuningProfile {
+    Engine engine = Engine::ParallelDivided;
+    int num_threads = 0;
+    std::size_t block_size = 512;
+    std::string cpu;
+};
+
+// DBSCAN_PROFILE si está definida; si no, data/results/autotune.profile.
+std::string defaultProfilePath();
+
+// Modelo de CPU según /proc/cpuinfo ("desconocido" si no se puede leer).
+std::string cpuModel();
+
+bool saveProfile(const std::string& ruta, const TuningProfile& perfil);
+
+// Devuelve false si el archivo no existe, no se puede interpretar o es de otra CPU.
+bool loadProfile(const std::string& ruta, TuningProfile& perfil);
+
+// Tamaños de bloque candidatos: los que hacen caber dos bloques (coordenadas y
+// conteos) en L1 y en L2, y sus vecinos en potencias de dos.
+std::vector<std::size_t> candidateBlockSizes();
+
+// Clusterer con el motor, hilos y bloque del perfil.
+inline Clusterer makeClusterer(const TuningProfile& perfil) {
+    return Clusterer(perfil.engine, perfil.num_threads, perfil.block_size);
+}
+
+// Mide motores, hilos y tamaños de bloque sobre una muestra de hasta `muestra`
+// puntos (epsilon escalado para conservar la densidad) y devuelve el más rápido.
+TuningProfile autotune(const std::vector<Point>& puntos, double epsilon, int min_samples, std::size_t muestra, std::ostream& log);
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "dbscan.hpp"
+#include "grid.hpp"
+#include "kdtree.hpp"
+#include "numa.hpp"
+#include "perf.hpp"
+#include "reorder.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class Engine {
+    Serial,
+    ParallelFull,
+    ParallelDivided,
+    ParallelTasks,
+    Grid,
+    KdTree,
+};
+
+const char* engineName(Engine engine);
+
+// Devuelve false si el nombre no corresponde a ningún motor.
+bool parseEngine(const std::string& nombre, Engine& engine);
+
+// Tiempos en segundos de la última corrida de un motor y pares de puntos cuya
+// distancia se evaluó al contar vecinos (0 si el motor no lo lleva, como el k-d tree).
+struct PhaseTimes {
+    double preparacion = 0.0;  // copia a SoA, índice de celdas o árbol
+    double conteo = 0.0;
+    double cores = 0.0;
+    double frontera = 0.0;
+    double pares = 0.0;
+
+    double total() const { return preparacion + conteo + cores + frontera; }
+};
+
+// Cronómetro por fases: lap() devuelve el tiempo desde la vuelta anterior. Con un
+// PerfReport activo, lap(fase) además lee los contadores de hardware de cada hilo; el
+// costo de esa lectura no se cuenta en la fase siguiente.
+class PhaseClock {
+public:
+    PhaseClock() : marca_(omp_get_wtime()) {}
+
+    explicit PhaseClock(PerfReport& perf) : perf_(perf.activo ? &perf : nullptr) {
+        if (perf_ != nullptr) {
+            perfBegin(*perf_);
+        }
+        marca_ = omp_get_wtime();
+    }
+
+    double lap() {
+        const double ahora = omp_get_wtime();
+        const double transcurrido = ahora - marca_;
+        marca_ = ahora;
+        return transcurrido;
+    }
+
+    double lap(PhasePerf& fase) {
+        const double transcurrido = lap();
+        if (perf_ != nullptr) {
+            perfLap(*perf_, fase, transcurrido);
+            marca_ = omp_get_wtime();
+        }
+        return transcurrido;
+    }
+
+private:
+    double marca_ = 0.0;
+    PerfReport* perf_ = nullptr;
+};
+
+// Buffers internos de los motores. Se redimensionan sin liberar memoria, así que
+// reutilizar el mismo Workspace entre llamadas evita reservar en cada corrida.
+//
+// Los arreglos por punto usan FirstTouchVector: crecen sin inicializarse y los llena
+// un bucle paralelo estático, así que en máquinas NUMA cada tramo queda en el nodo
+// del hilo que lo recorre.
+struct Workspace {
+    FirstTouchVector<int> vecinos;
+    FirstTouchVector<char> es_core;
+    PointsSoA soa;
+    PointsSoA cores;
+    GridIndex grid;
+    ::KdTree kdtree;
+    std::vector<double> coords;  // x,y intercalados para el k-d tree
+    std::vector<int> etiquetas;
+    std::vector<Caja> cajas;                // caja envolvente de cada bloque (P2)
+    std::vector<std::vector<int>> locales;  // buffers por hilo de parallel_divided
+    FirstTouchVector<int> privados;         // conteos por hilo (hilos x n), sin atómicos
+    std::size_t hilos_privados = 0;
+
+    // Vecinos registrados durante el conteo: hasta `capacidad` por punto con paso fijo
+    // (lista[i * capacidad + k]). Un punto que no es core tiene a lo más
+    // min_samples - 1 vecinos, así que su lista queda completa y la promoción a
+    // CORE2 es una pasada lineal sin volver a calcular distancias.
+    FirstTouchVector<int> lista;
+    FirstTouchVector<int> llenado;  // entradas intentadas por punto (puede exceder capacidad)
+    std::size_t capacidad = 0;
+    bool usa_lista = false;
+
+    PhaseTimes fases;
+    PerfReport perf;  // solo se llena si perf.activo
+};
+
+// Tope de entradas de la lista de vecinos; si n * (min_samples - 1) lo excede se usa
+// el barrido contra los cores.
+constexpr std::size_t LISTA_VECINOS_MAX = std::size_t{1} << 28;
+
+// Dimensiona ws.lista para n puntos. Devuelve ws.usa_lista.
+bool prepareNeighborLists(Workspace& ws, std::size_t n, int min_samples);
+
+// Registra b en la lista de vecinos de a. La lectura previa evita el atómico una vez
+// que la lista está llena, lo que ocurre pronto en los puntos densos (los cores).
+inline void recordNeighbor(int* llenado, int* lista, std::size_t cap, std::size_t a, std::size_t b) {
+    int actual;
+#pragma omp atomic read
+    actual = llenado[a];
+    if (static_cast<std::size_t>(actual) >= cap) {
+        return;
+    }
+    int slot;
+#pragma omp atomic capture
+    slot = llenado[a]++;
+    if (static_cast<std::size_t>(slot) < cap) {
+        lista[a * cap + static_cast<std::size_t>(slot)] = static_cast<int>(b);
+    }
+}
+
+// Tope de ws.privados; por encima los motores P1/P2 vuelven a los atómicos.
+constexpr std::size_t CONTEOS_PRIVADOS_MAX = std::size_t{1} << 27;
+
+// Reserva y pone en cero un arreglo de n conteos por hilo (cada hilo limpia el
+// suyo). Devuelve el arreglo del hilo 0 o nullptr si excede CONTEOS_PRIVADOS_MAX.
+int* preparePrivateCounts(Workspace& ws, std::size_t n, std::size_t hilos);
+
+// ws.vecinos[i] = suma de los conteos privados de i, en paralelo sobre i.
+void reducePrivateCounts(Workspace& ws, std::size_t n);
+
+// Promueve a CORE2 los NOISE que tienen algún CORE1 en su lista de vecinos.
+void assignBordersFromLists(std::vector<Point>& puntos, const Workspace& ws, bool paralelo);
+
+// Promueve a CORE2 los NOISE con un CORE1 a distancia^2 <= eps2: con las listas de
+// vecinos si el motor las llenó, si no con un barrido contra un SoA de los cores.
+void assignBorders(std::vector<Point>& puntos, Workspace& ws, double eps2, bool paralelo);
+
+// Deja todos los puntos como NOISE y sin cluster antes de etiquetar.
+void resetLabels(std::vector<Point>& puntos);
+
+// Variantes que trabajan sobre puntos del llamador: escriben label en el lugar.
+void dbscan_serial(std::vector<Point>& puntos, double epsilon, int min_samples, Workspace& ws);
+
+void dbscan_parallel_full(std::vector<Point>& puntos, double epsilon, int min_samples, int num_threads, Workspace& ws);
+
+void dbscan_parallel_divided(std::vector<Point>& puntos, double epsilon, int min_samples, int num_threads, std::size_t block_size, Workspace& ws);
+
+void dbscan_parallel_tasks(std::vector<Point>& puntos, double epsilon, int min_samples, int num_threads, std::size_t block_size, Workspace& ws);
+
+void dbscan_grid(std::vector<Point>& puntos, double epsilon, int min_samples, int num_threads, Workspace& ws);
+
+void dbscan_kdtree(std::vector<Point>& puntos, double epsilon, int min_samples, int num_threads, Workspace& ws);
+
+// Reconstruye el índice en grid reutilizando sus buffers.
+void buildGrid(const std::vector<Point>& puntos, double epsilon, GridIndex& grid);
+
+// Ejecuta un motor sobre puntos del llamador reutilizando los buffers entre llamadas.
+class Clusterer {
+public:
+    explicit Clusterer(Engine engine = Engine::Grid, int num_threads = 0, std::size_t block_size = 512);
+
+    void run(std::vector<Point>& puntos, double epsilon, int min_samples);
+
+    Engine engine() const { return engine_; }
+    void setEngine(Engine engine) { engine_ = engine; }
+    int threads() const { return num_threads_; }
+    void setThreads(int num_threads) { num_threads_ = num_threads; }
+    std::size_t blockSize() const { return block_size_; }
+    void setBlockSize(std::size_t block_size) { block_size_ = block_size; }
+
+    // Con una curva distinta de Ninguna, run ordena una copia de los puntos a lo largo
+    // de ella, etiqueta la copia y devuelve las etiquetas al orden del llamador. Los
+    // bloques de P2 y de tareas quedan compactos y sus mosaicos lejanos se descartan.
+    // El tiempo de ordenar y devolver se suma a phases().preparacion.
+    void setCurve(Curve curva) { curva_ = curva; }
+    Curve curve() const { return curva_; }
+    // orden[k] = índice del llamador del k-ésimo punto de la última corrida ordenada.
+    const std::vector<std::size_t>& permutation() const { return orden_.orden; }
+
+    // Tiempos por fase de la última llamada a run.
+    const PhaseTimes& phases() const { return ws_.fases; }
+
+    // Contadores de hardware y tiempo ocupado por hilo en cada fase (ver perf.hpp).
+    void setPerf(bool activo) { ws_.perf.activo = activo; }
+    const PerfReport& perf() const { return ws_.perf; }
+
+private:
+    void dispatch(std::vector<Point>& puntos, double epsilon, int min_samples);
+
+    Engine engine_;
+    int num_threads_;
+    std::size_t block_size_;
+    Curve curva_ = Curve::Ninguna;
+    Workspace ws_;
+    SpatialOrder orden_;
+    std::vector<Point> ordenados_;
+};
@@ -7,11 +7,12 @@ constexpr int NOISE = -1;
 constexpr int CORE1 = 1;
 constexpr int CORE2 = 2;
 
-// Estructura de un punto (coordenadas x,y y etiqueta)
+// Estructura de un punto (coordenadas x,y, etiqueta e identificador de cluster)
 struct Point {
     double x{};
     double y{};
     int label = NOISE;
+    int cluster = NOISE;  // NOISE mientras no se llame a assignClusters
 };
 
 // Utilidades compartidas
@@ -27,3 +28,19 @@ std::vector<Point> dbscan_serial(const std::string& ruta, double epsilon, int mi
 std::vector<Point> dbscan_parallel_full(const std::string& ruta, double epsilon, int min_samples, int num_threads = 0);
 
 std::vector<Point> dbscan_parallel_divided(const std::string& ruta, double epsilon, int min_samples, int num_threads = 0, std::size_t block_size = 512);
+
+// Mosaicos de P2 como tareas OpenMP; los más caros (según la ocupación de la grilla)
+// se parten en sub-mosaicos y los que están a más de epsilon se omiten.
+std::vector<Point> dbscan_parallel_tasks(const std::string& ruta, double epsilon, int min_samples, int num_threads = 0, std::size_t block_size = 512);
+
+// Índice de celdas de lado epsilon: cada punto solo se compara con su vecindario 3x3.
+std::vector<Point> dbscan_grid(const std::string& ruta, double epsilon, int min_samples, int num_threads = 0);
+
+// k-d tree construido en paralelo; el conteo se detiene al llegar a min_samples.
+std::vector<Point> dbscan_kdtree(const std::string& ruta, double epsilon, int min_samples, int num_threads = 0);
+
+// Clustering completo: une los CORE1 a distancia <= epsilon en componentes con un
+// union-find concurrente y asigna cada CORE2 al cluster de un core vecino.
+void assignClusters(std::vector<Point>& puntos, double epsilon, int num_threads = 0);
+
+std::vector<Point> dbscan_clusters(const std::string& ruta, double epsilon, int min_samples, int num_threads = 0);
@@ -0,0 +1,302 @@
+#pragma once
+
+#include "clusterer.hpp"
+#include "dbscan.hpp"
+#include "pair_count.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Versión genérica de los tres algoritmos: escalar T (float o double) y dimensión D
+// fijada en compilación. D = 0 indica dimensión conocida solo en tiempo de ejecución.
+constexpr int DIM_DINAMICA = 0;
+
+// Conjunto de puntos fila-mayor (n x dims) con sus etiquetas.
+template <typename T, int D>
+struct PointSetN {
+    std::vector<T> coords;
+    std::vector<int> labels;
+    std::size_t dims = D;
+
+    std::size_t size() const { return dims == 0 ? 0 : coords.size() / dims; }
+    const T* point(std::size_t i) const { return coords.data() + i * dimension(); }
+
+    // Con D > 0 la dimensión es una constante y los bucles que la usan se desenrollan.
+    constexpr std::size_t dimension() const {
+        if constexpr (D > 0) {
+            return static_cast<std::size_t>(D);
+        } else {
+            return dims;
+        }
+    }
+};
+
+// Suma de cuadrados desde la última dimensión hacia la primera, con fma donde la haya:
+// el mismo orden que distanceSquaredN (kdtree.hpp) y, para D = 2, que squaredNorm
+// (soa.hpp). Así los empates a distancia exactamente eps se resuelven igual en todos
+// los motores.
+template <typename T>
+inline T accumulateSquare(T d, T acumulado) {
+#ifdef __FMA__
+    return std::fma(d, d, acumulado);
+#else
+    return d * d + acumulado;
+#endif
+}
+
+// Candidatos que compara maskWithinN de una vez.
+constexpr std::size_t LOTE_N = 64;
+
+// Coordenadas por columna (una por dimensión, alineadas) para el núcleo por lotes,
+// como PointsSoA en 2D. Cada columna lleva LOTE_N entradas de relleno al final para
+// que el núcleo lea siempre un lote completo.
+template <typename T, int D>
+struct PointsSoAN {
+    std::vector<std::vector<T, AlignedAllocator<T>>> columnas;
+    std::size_t n = 0;
+
+    std::size_t size() const { return n; }
+    std::size_t dimension() const { return columnas.size(); }
+    const T* column(std::size_t k) const { return columnas[k].data(); }
+
+    void assign(const PointSetN<T, D>& s) {
+        n = s.size();
+        const std::size_t dims = s.dimension();
+        columnas.resize(dims);
+        for (auto& columna : columnas) {
+            columna.resize(n + LOTE_N);
+            std::fill(columna.begin() + static_cast<std::ptrdiff_t>(n), columna.end(), T{});
+        }
+#pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < n; ++i) {
+            const T* p = s.point(i);
+            for (std::size_t k = 0; k < dims; ++k) {
+                columnas[k][i] = p[k];
+            }
+        }
+    }
+
+    // Solo los puntos con etiqueta CORE1, en el orden original.
+    void assignCores(const PointSetN<T, D>& s) {
+        const std::size_t dims = s.dimension();
+        columnas.assign(dims, {});
+        n = 0;
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            if (s.labels[i] == CORE1) {
+                for (std::size_t k = 0; k < dims; ++k) {
+                    columnas[k].push_back(s.point(i)[k]);
+                }
+                ++n;
+            }
+        }
+        for (auto& columna : columnas) {
+            columna.resize(n + LOTE_N, T{});
+        }
+    }
+};
+
+// Bit k encendido si el candidato j0 + k de soa está a distancia^2 <= eps2 de q
+// (len <= LOTE_N). Recorre columna por columna un lote completo (el relleno cubre el
+// final) y descarta los bits desde len: cada pasada es un bucle de largo fijo que el
+// compilador vectoriza, y con float entran el doble de candidatos por registro.
+template <typename T, int D>
+std::uint64_t maskWithinN(const T* q, const PointsSoAN<T, D>& soa, std::size_t j0, std::size_t len, T eps2) {
+    std::size_t dims = soa.dimension();
+    if constexpr (D > 0) {
+        dims = static_cast<std::size_t>(D);
+    }
+    alignas(64) T acumulado[LOTE_N];
+    const T* ultima = soa.column(dims - 1) + j0;
+    const T q_ultima = q[dims - 1];
+#pragma omp simd
+    for (std::size_t k = 0; k < LOTE_N; ++k) {
+        const T d = q_ultima - ultima[k];
+        acumulado[k] = d * d;
+    }
+    for (std::size_t c = dims - 1; c-- > 0;) {
+        const T* columna = soa.column(c) + j0;
+        const T qc = q[c];
+#pragma omp simd
+        for (std::size_t k = 0; k < LOTE_N; ++k) {
+            acumulado[k] = accumulateSquare<T>(qc - columna[k], acumulado[k]);
+        }
+    }
+    std::uint64_t mask = 0;
+#pragma omp simd reduction(| : mask)
+    for (std::size_t k = 0; k < LOTE_N; ++k) {
+        mask |= static_cast<std::uint64_t>(acumulado[k] <= eps2) << k;
+    }
+    return len >= LOTE_N ? mask : mask & ((std::uint64_t{1} << len) - 1);
+}
+
+namespace detail {
+
+// Deja etiquetas en NOISE, ws.vecinos en cero y prepara las listas de vecinos.
+template <typename T, int D>
+void prepareN(PointSetN<T, D>& s, PointsSoAN<T, D>& soa, Workspace& ws, int min_samples) {
+    const std::size_t n = s.size();
+    s.labels.assign(n, NOISE);
+    firstTouchAssign(ws.vecinos, n, 0);
+    soa.assign(s);
+    if (prepareNeighborLists(ws, n, min_samples)) {
+        firstTouchAssign(ws.llenado, n, 0);
+    }
+}
+
+// Marca CORE1 según ws.vecinos y promueve a CORE2 los NOISE cercanos a un core: con
+// las listas de vecinos si se llenaron, si no con un barrido contra los cores.
+template <typename T, int D>
+void labelFromCountsN(PointSetN<T, D>& s, Workspace& ws, T eps2, int min_samples, bool paralelo) {
+    const std::size_t n = s.size();
+#pragma omp parallel for schedule(static) if (paralelo)
+    for (std::size_t i = 0; i < n; ++i) {
+        if (ws.vecinos[i] >= min_samples) {
+            s.labels[i] = CORE1;
+        }
+    }
+
+    if (ws.usa_lista) {
+#pragma omp parallel for schedule(static) if (paralelo)
+        for (std::size_t i = 0; i < n; ++i) {
+            if (s.labels[i] == NOISE &&
+                listedNeighborIsCore(ws, i, [&](std::size_t j) { return s.labels[j] == CORE1; })) {
+                s.labels[i] = CORE2;
+            }
+        }
+        return;
+    }
+
+    PointsSoAN<T, D> cores;
+    cores.assignCores(s);
+    const std::size_t m = cores.size();
+#pragma omp parallel for schedule(dynamic, 256) if (paralelo)
+    for (std::size_t i = 0; i < n; ++i) {
+        if (s.labels[i] != NOISE) {
+            continue;
+        }
+        for (std::size_t j0 = 0; j0 < m; j0 += LOTE_N) {
+            if (maskWithinN(s.point(i), cores, j0, std::min<std::size_t>(LOTE_N, m - j0), eps2) != 0) {
+                s.labels[i] = CORE2;
+                break;
+            }
+        }
+    }
+}
+
+}
+
+// Las tres variantes usan el núcleo por columnas y los buffers de ws como sus pares
+// 2D: conteos privados por hilo y listas de vecinos para la frontera. Las sobrecargas
+// sin Workspace crean uno por llamada.
+template <typename T, int D>
+void dbscanSerialN(PointSetN<T, D>& s, T epsilon, int min_samples, Workspace& ws) {
+    const std::size_t n = s.size();
+    const T eps2 = epsilon * epsilon;
+    PointsSoAN<T, D> soa;
+    detail::prepareN(s, soa, ws, min_samples);
+    int* vecinos = ws.vecinos.data();
+    int* lista = ws.lista.data();
+    const std::size_t cap = ws.capacidad;
+
+    // Como dbscan_serial: el conteo previo de cada punto es la posición libre en su lista.
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j0 = i + 1; j0 < n; j0 += LOTE_N) {
+            const std::size_t len = std::min<std::size_t>(LOTE_N, n - j0);
+            std::uint64_t mask = maskWithinN(s.point(i), soa, j0, len, eps2);
+            if (!ws.usa_lista) {
+                vecinos[i] += popcount64(mask);
+            }
+            while (mask != 0) {
+                const std::size_t j = j0 + lowestBit64(mask);
+                if (ws.usa_lista) {
+                    const std::size_t slot_i = static_cast<std::size_t>(vecinos[i]++);
+                    if (slot_i < cap) {
+                        lista[i * cap + slot_i] = static_cast<int>(j);
+                    }
+                    const std::size_t slot_j = static_cast<std::size_t>(vecinos[j]);
+                    if (slot_j < cap) {
+                        lista[j * cap + slot_j] = static_cast<int>(i);
+                    }
+                }
+                ++vecinos[j];
+                mask &= mask - 1;
+            }
+        }
+    }
+
+    detail::labelFromCountsN(s, ws, eps2, min_samples, false);
+}
+
+template <typename T, int D>
+void dbscanParallelFullN(PointSetN<T, D>& s, T epsilon, int min_samples, int num_threads, Workspace& ws) {
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+    const std::size_t n = s.size();
+    const T eps2 = epsilon * epsilon;
+    PointsSoAN<T, D> soa;
+    detail::prepareN(s, soa, ws, min_samples);
+    int* privados = preparePrivateCounts(ws, n, static_cast<std::size_t>(omp_get_max_threads()));
+
+    countPairsByRows(n, ws, privados, [&](std::size_t i, std::size_t j0, std::size_t len) {
+        return maskWithinN(s.point(i), soa, j0, len, eps2);
+    });
+
+    detail::labelFromCountsN(s, ws, eps2, min_samples, true);
+}
+
+template <typename T, int D>
+void dbscanParallelDividedN(PointSetN<T, D>& s, T epsilon, int min_samples, int num_threads, std::size_t block_size,
+                            Workspace& ws) {
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+    if (block_size == 0) {
+        block_size = 512;
+    }
+    const std::size_t n = s.size();
+    const T eps2 = epsilon * epsilon;
+    PointsSoAN<T, D> soa;
+    detail::prepareN(s, soa, ws, min_samples);
+    int* privados = preparePrivateCounts(ws, n, static_cast<std::size_t>(omp_get_max_threads()));
+
+    countPairsByTiles(
+        n, block_size, ws, privados,
+        [&](std::size_t i, std::size_t j0, std::size_t len) { return maskWithinN(s.point(i), soa, j0, len, eps2); },
+        [](std::size_t, std::size_t) { return false; });
+
+    detail::labelFromCountsN(s, ws, eps2, min_samples, true);
+}
+
+template <typename T, int D>
+void dbscanSerialN(PointSetN<T, D>& s, T epsilon, int min_samples) {
+    Workspace ws;
+    dbscanSerialN(s, epsilon, min_samples, ws);
+}
+
+template <typename T, int D>
+void dbscanParallelFullN(PointSetN<T, D>& s, T epsilon, int min_samples, int num_threads = 0) {
+    Workspace ws;
+    dbscanParallelFullN(s, epsilon, min_samples, num_threads, ws);
+}
+
+template <typename T, int D>
+void dbscanParallelDividedN(PointSetN<T, D>& s, T epsilon, int min_samples, int num_threads = 0, std::size_t block_size = 512) {
+    Workspace ws;
+    dbscanParallelDividedN(s, epsilon, min_samples, num_threads, block_size, ws);
+}
+
+// Lee un CSV numérico e infiere el número de columnas de la primera fila válida.
+// Devuelve false si no se pudo abrir o no tiene filas numéricas.
+template <typename T>
+bool loadCoordinatesCSV(const std::string& archivo, std::vector<T>& coords, std::size_t& dims);
+
+extern template bool loadCoordinatesCSV<float>(const std::string&, std::vector<float>&, std::size_t&);
+extern template bool loadCoordinatesCSV<double>(const std::string&, std::vector<double>&, std::size_t&);
@@ -0,0 +1,62 @@
+#pragma once
+
+// DBSCAN distribuido con MPI. Solo se compila con -DDBSCAN_MPI (mpicxx); sin esa
+// bandera el binario no depende de MPI y --mpi responde con un aviso.
+#ifdef DBSCAN_MPI
+
+#include "clusterer.hpp"
+#include "dbscan.hpp"
+
+#include <mpi.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Resultado en un rango: el trozo de la entrada que leyó, ya etiquetado, más datos
+// de la partición para el reporte.
+struct DistributedResult {
+    std::vector<Point> puntos;  // puntos [primero, primero + puntos.size()) de la entrada
+    std::int64_t primero = 0;
+    std::int64_t total = 0;
+    std::size_t propios = 0;  // puntos de la franja de este rango
+    std::size_t halo = 0;     // puntos de otras franjas a menos de epsilon
+    std::size_t promovidos = 0;  // halo que resultó core solo al reconciliar
+    double corte_min = 0.0;   // franja [corte_min, corte_max) en x
+    double corte_max = 0.0;
+    double lectura = 0.0;
+    double reparto = 0.0;
+    double local = 0.0;
+    double reconciliacion = 0.0;
+};
+
+// Cada rango lee un trozo contiguo de la entrada (.bin por índice, CSV por bytes
+// hasta un salto de línea). Los puntos se reparten en franjas de x con cortes en los
+// cuantiles de una muestra, cada franja recibe de las vecinas los puntos a menos de
+// epsilon de su borde (halo) y corre `engine` con OpenMP sobre propios + halo:
+//   - El conteo de un punto propio es exacto, porque todos sus vecinos están en la
+//     franja o en el halo, así que su CORE1 también.
+//   - Un punto de halo que sale core localmente lo es de verdad (su conteo local no
+//     puede exceder el real), pero puede faltar alguno. El dueño de cada punto de
+//     halo devuelve su estado core y los NOISE propios cerca del borde se revisan
+//     contra los cores de halo que faltaban.
+//   - Clusters: assignClusters sobre propios + halo da los componentes locales; los
+//     que cruzan franjas se unen propagando entre rangos el menor índice global de sus
+//     cores. La numeración final es la de assignClusters sobre la entrada completa.
+// Al final etiquetas y clusters vuelven al rango que leyó cada punto, en el orden de
+// la entrada. Llamada colectiva sobre comm.
+DistributedResult dbscan_distributed(const std::string& ruta,
+                                     double epsilon,
+                                     int min_samples,
+                                     Engine engine,
+                                     int num_threads,
+                                     std::size_t block_size,
+                                     MPI_Comm comm);
+
+// Escribe un .bin con etiquetas (formato de writeResultsBinary): cada rango escribe su
+// trozo con pwrite y el rango 0 el encabezado. Requiere que todos los rangos vean el
+// mismo archivo. Llamada colectiva; devuelve false si algún rango falló.
+bool writeDistributedResults(const DistributedResult& resultado, const std::string& archivo, MPI_Comm comm);
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "dbscan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Conjuntos sintéticos. Los puntos uniformes y los centros de las gaussianas caen en
+// el cuadrado unitario; las colas de las gaussianas no se recortan, así que blobs,
+// skewed y noise tienen puntos fuera de [0, 1]² (más cuanto mayor la desviación).
+//   uniform: puntos uniformes, sin estructura.
+//   blobs:   gaussianas isotrópicas del mismo tamaño (como make_blobs del notebook).
+//   skewed:  gaussianas con pesos y anchos muy distintos: unas pocas celdas concentran
+//            la mayoría de los puntos.
+//   noise:   blobs con la mitad de los puntos como ruido uniforme.
+enum class Distribution {
+    Uniform,
+    Blobs,
+    Skewed,
+    Noise,
+};
+
+const char* distributionName(Distribution dist);
+
+// Devuelve false si el nombre no corresponde a ninguna distribución.
+bool parseDistribution(const std::string& nombre, Distribution& dist);
+
+struct GeneratorOptions {
+    Distribution dist = Distribution::Blobs;
+    std::size_t count = 0;
+    std::uint64_t seed = 208450;
+    int centros = 4;
+    double desviacion = 0.06;
+};
+
+// El punto i depende solo de (seed, i): el resultado es el mismo con cualquier
+// número de hilos y cualquier división en trozos.
+Point generatePoint(const GeneratorOptions& opciones, std::size_t i);
+
+std::vector<Point> generatePoints(const GeneratorOptions& opciones);
+
+// Genera por trozos directo al archivo (.bin binario, otro CSV "x,y") sin tener todos
+// los puntos en memoria. Devuelve false si no se pudo escribir.
+bool generateFile(const GeneratorOptions& opciones, const std::string& archivo);
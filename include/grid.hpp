@@ -0,0 +1,42 @@
+#pragma once
+
+#include "dbscan.hpp"
+#include "numa.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// Índice espacial uniforme: los puntos se agrupan en celdas de lado >= epsilon,
+// de modo que todos los vecinos de un punto están en su celda o en las 8 adyacentes.
+struct GridIndex {
+    double min_x{};
+    double min_y{};
+    double cell{};
+    std::size_t cols{};
+    std::size_t rows{};
+    std::vector<std::size_t> inicio;  // offsets de cada celda en orden/xs/ys (cols*rows + 1)
+    std::vector<std::size_t> orden;   // índice original del punto en cada posición ordenada
+    std::vector<std::size_t> celda;   // celda de cada punto, en orden original
+    FirstTouchVector<double> xs;      // coordenadas en orden de celda (contiguas por celda)
+    FirstTouchVector<double> ys;
+
+    std::size_t cellOf(double x, double y) const;
+    std::size_t cellCol(std::size_t c) const { return c % cols; }
+    std::size_t cellRow(std::size_t c) const { return c / cols; }
+
+    // Llama f(q_ini, q_fin) con los tres rangos contiguos del vecindario 3x3 de la celda c.
+    template <typename F>
+    void forEachNeighborRange(std::size_t c, F&& f) const {
+        const std::size_t col = cellCol(c);
+        const std::size_t row = cellRow(c);
+        const std::size_t col_ini = col > 0 ? col - 1 : 0;
+        const std::size_t col_fin = col + 1 < cols ? col + 1 : col;
+        const std::size_t row_ini = row > 0 ? row - 1 : 0;
+        const std::size_t row_fin = row + 1 < rows ? row + 1 : row;
+        for (std::size_t r = row_ini; r <= row_fin; ++r) {
+            f(inicio[r * cols + col_ini], inicio[r * cols + col_fin + 1]);
+        }
+    }
+};
+
+GridIndex buildGrid(const std::vector<Point>& puntos, double epsilon);
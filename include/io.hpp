@@ -0,0 +1,147 @@
+#pragma once
+
+#include "dbscan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Archivo proyectado en memoria de solo lectura (mmap). Se libera al destruirse.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& archivo);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& otro) noexcept;
+    MappedFile& operator=(MappedFile&& otro) noexcept;
+
+    bool ok() const { return ok_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void release();
+
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool ok_ = false;
+};
+
+// Interpreta un buffer CSV "x,y" en paralelo: divide el texto en trozos que terminan
+// en salto de línea, cuenta líneas para dimensionar la salida y cada hilo escribe
+// sus puntos directamente en su rango. Las líneas que no se pueden leer se omiten.
+std::vector<Point> parsePointsCSV(const char* data, std::size_t size);
+
+// Formato binario columnar (.bin). Encabezado fijo de 64 bytes, después la caja
+// envolvente (dims mínimos y dims máximos en double) y luego las columnas, cada una
+// alineada a 64 bytes: dims columnas de double y, si hay etiquetas, label y cluster
+// como int32. El archivo se puede proyectar con mmap y usar sin interpretar texto.
+// Un archivo solo de etiquetas tiene dims = 0: sin caja ni coordenadas.
+struct BinaryHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t dims;
+    std::uint64_t count;
+    std::uint32_t etiquetas;    // 1 si el archivo trae columnas label y cluster
+    std::uint32_t reservado;
+    std::uint64_t data_offset;  // inicio de la primera columna
+    std::uint64_t reservado2[3];
+};
+static_assert(sizeof(BinaryHeader) == 64, "el encabezado binario debe medir 64 bytes");
+
+constexpr char BINARY_MAGIC[8] = {'D', 'B', 'S', 'C', 'A', 'N', 'P', 'T'};
+constexpr std::uint32_t BINARY_VERSION = 1;
+
+bool isBinaryPath(const std::string& archivo);
+
+// Vista sin copia de un archivo .bin: las columnas apuntan directo al mapa.
+class MappedPoints {
+public:
+    explicit MappedPoints(const std::string& archivo);
+
+    bool ok() const { return header_ != nullptr; }
+    std::size_t size() const { return ok() ? static_cast<std::size_t>(header_->count) : 0; }
+    std::size_t dims() const { return ok() ? header_->dims : 0; }
+    bool hasLabels() const { return ok() && header_->etiquetas != 0; }
+
+    const double* column(std::size_t d) const;
+    const double* boundsMin() const;
+    const double* boundsMax() const;
+    const std::int32_t* labels() const;
+    const std::int32_t* clusters() const;
+
+private:
+    std::size_t columnOffset(std::size_t columna) const;
+
+    MappedFile mapa_;
+    const BinaryHeader* header_ = nullptr;
+};
+
+std::vector<Point> loadPointsBinary(const std::string& archivo);
+
+// Escribe puntos (y opcionalmente label/cluster) en formato .bin. Devuelve false si falla.
+bool writePointsBinary(const std::vector<Point>& puntos, const std::string& archivo, bool con_etiquetas);
+
+// Escribe label y cluster de los puntos en un .bin con dims = 0, en el orden de puntos.
+bool writeLabelsBinary(const std::vector<Point>& puntos, const std::string& archivo);
+
+// Escribe un CSV "x,y,label,cluster" (o "label,cluster" sin coordenadas). Las filas
+// se formatean por trozos en paralelo con std::to_chars (los doubles con la
+// representación más corta que se vuelve a leer exacta) y cada trozo se escribe con
+// pwrite en su posición; la memoria extra es un trozo por hilo.
+bool writePointsCSV(const std::vector<Point>& puntos, const std::string& archivo, bool con_coordenadas);
+
+// Escritor de un .bin de puntos 2D cuyo número de puntos se conoce de antemano. Los
+// trozos se escriben con pwrite en su posición final, en cualquier orden, y el
+// encabezado con la caja envolvente se escribe al cerrar. Permite producir archivos
+// más grandes que la memoria. Con crear = false abre un archivo que otro escritor ya
+// dimensionó, para que varios procesos escriban trozos distintos; solo uno cierra.
+class BinaryPointWriter {
+public:
+    BinaryPointWriter(const std::string& archivo, std::uint64_t count, bool con_etiquetas = false, bool crear = true);
+    ~BinaryPointWriter();
+
+    BinaryPointWriter(const BinaryPointWriter&) = delete;
+    BinaryPointWriter& operator=(const BinaryPointWriter&) = delete;
+
+    bool ok() const { return fd_ >= 0; }
+
+    // Escribe los puntos [inicio, inicio + cuantos).
+    bool write(std::uint64_t inicio, const double* xs, const double* ys, std::size_t cuantos);
+
+    // Escribe label y cluster de [inicio, inicio + cuantos); requiere con_etiquetas.
+    bool writeLabels(std::uint64_t inicio, const std::int32_t* labels, const std::int32_t* clusters, std::size_t cuantos);
+
+    // Posición en bytes de la columna label dentro del archivo.
+    std::uint64_t labelsOffset() const;
+
+    bool close(const double minimos[2], const double maximos[2]);
+
+private:
+    int fd_ = -1;
+    BinaryHeader header_{};
+};
+
+// Contraparte binaria de writeResultsCSV: escribe <n>_results_<etiqueta>.bin.
+std::string writeResultsBinary(const std::vector<Point>& puntos, const std::string& output_dir, const std::string& etiqueta);
+
+// Qué escribe main después de cada motor, según DBSCAN_OUTPUT: Completa (por defecto,
+// coordenadas y etiquetas en el formato de la entrada), Etiquetas ("etiquetas": solo
+// label y cluster en el formato de la entrada) o EtiquetasBinario ("etiquetas_bin").
+enum class OutputMode {
+    Completa,
+    Etiquetas,
+    EtiquetasBinario,
+};
+
+OutputMode outputModeRequested();
+
+// Escribe <n>_labels_<etiqueta>.csv o .bin solo con label y cluster.
+std::string writeLabelsOnly(const std::vector<Point>& puntos,
+                            const std::string& output_dir,
+                            const std::string& etiqueta,
+                            bool binario);
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "dbscan.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Distancia al cuadrado en dims dimensiones. Para dims == 2 coincide bit a bit con
+// squaredNorm (soa.hpp), de modo que las etiquetas 2D son idénticas a las del serial.
+inline double distanceSquaredN(const double* a, const double* b, std::size_t dims) {
+    const double ultimo = a[dims - 1] - b[dims - 1];
+    double acumulado = ultimo * ultimo;
+    for (std::size_t k = dims - 1; k-- > 0;) {
+        const double d = a[k] - b[k];
+#ifdef __FMA__
+        acumulado = std::fma(d, d, acumulado);
+#else
+        acumulado = d * d + acumulado;
+#endif
+    }
+    return acumulado;
+}
+
+// k-d tree sobre coordenadas fila-mayor (n x dims). Cada nodo guarda su caja
+// envolvente: los nodos fuera de epsilon se descartan y los que caen completos
+// dentro de epsilon se cuentan sin revisar punto por punto.
+class KdTree {
+public:
+    // Construye en paralelo (tareas OpenMP por subárbol). Copia las coordenadas.
+    void build(const double* coords, std::size_t n, std::size_t dims, std::size_t hoja = 16);
+
+    std::size_t size() const { return indice_.size(); }
+    std::size_t dims() const { return dims_; }
+
+    // Cuenta puntos del árbol a distancia^2 <= eps2 de q (incluido q si pertenece al
+    // árbol) y se detiene en cuanto la cuenta llega a limite.
+    std::size_t countWithin(const double* q, double eps2, std::size_t limite) const;
+
+    // true si existe un punto a distancia^2 <= eps2 de q cuyo índice original
+    // cumple aceptar(indice). Termina en el primero.
+    template <typename F>
+    bool anyWithin(const double* q, double eps2, F&& aceptar) const;
+
+private:
+    struct Nodo {
+        std::size_t inicio;
+        std::size_t fin;
+        std::size_t izq;  // 0 si es hoja (la raíz nunca es hijo)
+        std::size_t der;
+    };
+
+    std::size_t buildNode(std::size_t inicio, std::size_t fin, std::size_t profundidad);
+    double minDistance(std::size_t nodo, const double* q) const;
+    double maxDistance(std::size_t nodo, const double* q) const;
+    const double* coord(std::size_t pos) const { return &datos_[pos * dims_]; }
+
+    std::size_t dims_ = 0;
+    std::size_t hoja_ = 16;
+    std::vector<Nodo> nodos_;
+    std::vector<double> cajas_;        // por nodo: dims mínimos seguidos de dims máximos
+    std::vector<double> datos_;        // coordenadas en orden del árbol
+    std::vector<std::size_t> indice_;  // índice original de cada posición del árbol
+    std::size_t siguiente_ = 0;        // próximo nodo libre durante la construcción
+    const double* fuente_ = nullptr;   // coordenadas originales, solo durante build
+};
+
+template <typename F>
+bool KdTree::anyWithin(const double* q, double eps2, F&& aceptar) const {
+    if (nodos_.empty()) {
+        return false;
+    }
+    std::size_t pila[128];
+    std::size_t tope = 0;
+    pila[tope++] = 0;
+    while (tope > 0) {
+        const Nodo& nodo = nodos_[pila[--tope]];
+        if (minDistance(static_cast<std::size_t>(&nodo - nodos_.data()), q) > eps2) {
+            continue;
+        }
+        if (nodo.izq == 0) {
+            for (std::size_t pos = nodo.inicio; pos < nodo.fin; ++pos) {
+                if (aceptar(indice_[pos]) && distanceSquaredN(q, coord(pos), dims_) <= eps2) {
+                    return true;
+                }
+            }
+            continue;
+        }
+        pila[tope++] = nodo.der;
+        pila[tope++] = nodo.izq;
+    }
+    return false;
+}
+
+// Etiqueta (NOISE/CORE1/CORE2) n puntos fila-mayor de cualquier dimensión con un
+// árbol ya construido sobre esas mismas coordenadas. El conteo de vecinos se detiene
+// al llegar a min_samples, que es todo lo que necesita la clasificación de cores.
+void labelWithKdTree(const KdTree& arbol, const double* coords, std::size_t n, double epsilon, int min_samples, int* labels);
+
+// Las dos fases de labelWithKdTree por separado: es_core[i] = 1 si i tiene al menos
+// min_samples vecinos, y después NOISE/CORE1/CORE2 a partir de es_core.
+void markCoresKdTree(const KdTree& arbol, const double* coords, std::size_t n, double epsilon, int min_samples, char* es_core);
+
+void labelFromCoresKdTree(const KdTree& arbol, const double* coords, std::size_t n, double epsilon, const char* es_core, int* labels);
+
+// Atajo que construye el árbol y etiqueta; sirve para datos con 3 a 16 columnas.
+std::vector<int> dbscanLabelsKdTree(const double* coords, std::size_t n, std::size_t dims, double epsilon, int min_samples, int num_threads = 0);
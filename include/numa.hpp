@@ -0,0 +1,104 @@
+#pragma once
+
+#include <omp.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Reservador que no inicializa los elementos al crecer (resize sin valor). Las
+// páginas nuevas quedan sin tocar hasta que un bucle paralelo las escribe, así que
+// el kernel las asigna al nodo NUMA del hilo que hace ese primer acceso.
+template <typename T>
+struct FirstTouchAllocator : std::allocator<T> {
+    using value_type = T;
+
+    FirstTouchAllocator() = default;
+    template <typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U>&) {}
+
+    template <typename U>
+    struct rebind {
+        using other = FirstTouchAllocator<U>;
+    };
+
+    template <typename U>
+    void construct(U* p) noexcept {
+        ::new (static_cast<void*>(p)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename T>
+using FirstTouchVector = std::vector<T, FirstTouchAllocator<T>>;
+
+// Deja v con n elementos sin tocar las páginas nuevas: si no cabe, reserva de cero
+// en lugar de copiar el contenido anterior desde un solo hilo.
+template <typename T>
+void firstTouchResize(FirstTouchVector<T>& v, std::size_t n) {
+    if (v.capacity() < n) {
+        FirstTouchVector<T> nuevo;
+        nuevo.reserve(n);
+        v.swap(nuevo);
+    }
+    v.resize(n);
+}
+
+// firstTouchResize y después v[i] = valor con schedule(static): cada hilo toca el
+// mismo tramo que recorrerán los bucles estáticos del motor.
+template <typename T>
+void firstTouchAssign(FirstTouchVector<T>& v, std::size_t n, const T& valor) {
+    firstTouchResize(v, n);
+    T* datos = v.data();
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) {
+        datos[i] = valor;
+    }
+}
+
+// Cómo se fijan los hilos de OpenMP a las CPUs: compacta llena un nodo NUMA antes de
+// pasar al siguiente; dispersa alterna nodos para sumar el ancho de banda de todos.
+enum class Affinity {
+    Ninguna,
+    Compacta,
+    Dispersa,
+};
+
+const char* affinityName(Affinity afinidad);
+
+// Devuelve false si el nombre no corresponde a ninguna afinidad.
+bool parseAffinity(const std::string& nombre, Affinity& afinidad);
+
+// Afinidad pedida en DBSCAN_AFFINITY (compacta|dispersa); Ninguna si no está.
+Affinity affinityRequested();
+
+// CPUs de cada nodo NUMA (de /sys/devices/system/node), limitadas a las que permite
+// la afinidad del proceso. Sin esa información queda un solo nodo con todas.
+struct NumaTopology {
+    std::vector<std::vector<int>> cpus;
+
+    std::size_t nodes() const { return cpus.size(); }
+    std::size_t cpuCount() const;
+};
+
+const NumaTopology& numaTopology();
+
+// Fija cada hilo de un equipo de num_threads (0 = el actual) a una CPU según la
+// afinidad. Los hilos del pool de OpenMP se reutilizan entre regiones del mismo
+// tamaño, así que queda vigente para los motores. Devuelve cuántos hilos se fijaron.
+int pinThreads(Affinity afinidad, int num_threads);
+
+// Nodo NUMA en que corre el hilo que llama (0 si no se puede saber).
+int currentNode();
+
+// Reparto por nodo de un arreglo ya escrito por un solo hilo (por ejemplo los
+// puntos que deja loadPoints): las páginas del tramo t de un schedule(static) se
+// mueven al nodo del hilo t con move_pages. Con un solo nodo no hace nada.
+// Devuelve las páginas que quedaron en el nodo pedido.
+std::size_t partitionPages(void* datos, std::size_t bytes);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "clusterer.hpp"
+#include "dbscan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct OutOfCoreOptions {
+    std::size_t memoria = std::size_t{1} << 30;  // presupuesto en bytes para una partición (mínimo 64 KiB)
+    Engine engine = Engine::Grid;
+    int num_threads = 0;
+    std::size_t block_size = 512;
+    std::string temporal;  // directorio de particiones; vacío = junto a la salida
+};
+
+struct OutOfCoreResult {
+    bool ok = false;
+    std::uint64_t total = 0;
+    std::size_t particiones = 0;
+    std::size_t mayor = 0;       // propios + halo de la partición más grande
+    std::uint64_t halo = 0;      // copias de halo escritas en total
+    std::uint64_t promovidos = 0;  // cores de halo que solo se vieron al reconciliar
+    double escaneo = 0.0;
+    double reparto = 0.0;
+    double local = 0.0;
+    double reconciliacion = 0.0;
+    std::string error;  // motivo cuando ok = false; la función no imprime nada
+};
+
+// Bytes por punto que se estiman para una partición en memoria: los registros leídos,
+// el vector<Point> y los buffers del motor (índice de celdas, conteos).
+constexpr std::size_t OOC_BYTES_POR_PUNTO = 128;
+
+// DBSCAN para entradas más grandes que la memoria. La entrada (.bin o CSV) se recorre
+// por trozos sin cargarla completa:
+//   1. Escaneo: número de puntos, caja envolvente y una muestra de (x, y). Las
+//      particiones salen de partir el plano en la mediana de la muestra, alternando
+//      ejes, hasta que cada región con su halo de ancho epsilon cabe en el
+//      presupuesto. Si una región no baja de ahí con ningún corte (epsilon grande
+//      frente a la densidad) se devuelve ok = false.
+//   2. Reparto: cada punto va al archivo de su partición y, si está a menos de
+//      epsilon de otra, también a su archivo de halo. Las coordenadas se copian a la
+//      salida. Con los conteos exactos se comprueba que ninguna partición pase del
+//      presupuesto antes de cargarla; si alguna pasa se devuelve ok = false.
+//   3. Local: cada partición con su halo se carga sola y se etiqueta con `engine`.
+//      Los conteos de los puntos propios son exactos; se guardan sus etiquetas y
+//      cuáles puntos del halo salieron core localmente.
+//   4. Reconciliación: los puntos de halo que son core en su partición pero no lo
+//      fueron localmente promueven a CORE2 a los NOISE propios cercanos. Las
+//      etiquetas se escriben en la salida en la posición de la entrada.
+// `salida` es un .bin con columnas label y cluster (cluster queda en NOISE).
+OutOfCoreResult dbscan_out_of_core(const std::string& ruta,
+                                   const std::string& salida,
+                                   double epsilon,
+                                   int min_samples,
+                                   const OutOfCoreOptions& opciones);
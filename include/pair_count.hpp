@@ -0,0 +1,209 @@
+#pragma once
+
+#include "clusterer.hpp"
+#include "perf.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Recorrido de pares de P1 y P2 compartido por los motores 2D y sus versiones
+// genéricas (dbscan_nd.hpp). Cada motor aporta su núcleo de distancia como
+// `mascara(i, j0, len)`: devuelve el bit k encendido si j0 + k es vecino de i
+// (len <= 64). Los conteos se suman en `privados` (preparePrivateCounts, un arreglo
+// por hilo) y se reducen a ws.vecinos; si `privados` es nulo se cuenta con atómicos.
+// Con ws.usa_lista los vecinos se registran además en ws.lista.
+//
+// Antes de llamar: ws.vecinos con n ceros y, con lista, ws.llenado también.
+
+// Registra el par vecino (i, j) en las listas de ambos.
+inline void recordPair(Workspace& ws, std::size_t i, std::size_t j) {
+    recordNeighbor(ws.llenado.data(), ws.lista.data(), ws.capacidad, i, j);
+    recordNeighbor(ws.llenado.data(), ws.lista.data(), ws.capacidad, j, i);
+}
+
+// true si algún vecino registrado de i cumple es_core(j). Solo es exacto para un i
+// que no es core: tiene a lo más min_samples - 1 vecinos y su lista está completa.
+template <typename EsCore>
+bool listedNeighborIsCore(const Workspace& ws, std::size_t i, EsCore&& es_core) {
+    const std::size_t cap = ws.capacidad;
+    const std::size_t total = std::min<std::size_t>(cap, static_cast<std::size_t>(ws.vecinos[i]));
+    const int* lista = ws.lista.data() + i * cap;
+    for (std::size_t k = 0; k < total; ++k) {
+        if (es_core(static_cast<std::size_t>(lista[k]))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// P1: la fila i compara n - i - 1 pares. Emparejar la fila k con la n - 1 - k deja
+// iteraciones de costo casi igual, así que el reparto estático queda balanceado.
+template <typename Mascara>
+void countPairsByRows(std::size_t n, Workspace& ws, int* privados, Mascara&& mascara) {
+    int* compartidos = ws.vecinos.data();
+    const bool usa_lista = ws.usa_lista;
+    const std::size_t mitades = (n + 1) / 2;
+#pragma omp parallel
+    {
+        // El for no espera al final: lo que queda hasta la barrera es tiempo ocioso.
+        BusyTimer ocupado(ws.perf.conteo);
+        int* mio = privados != nullptr ? privados + static_cast<std::size_t>(omp_get_thread_num()) * n : nullptr;
+
+        auto contarFila = [&](std::size_t i) {
+            int propios = 0;
+            for (std::size_t j0 = i + 1; j0 < n; j0 += 64) {
+                const std::size_t len = std::min<std::size_t>(64, n - j0);
+                std::uint64_t mask = mascara(i, j0, len);
+                propios += popcount64(mask);
+                while (mask != 0) {
+                    const std::size_t j = j0 + lowestBit64(mask);
+                    if (mio != nullptr) {
+                        ++mio[j];
+                    } else {
+#pragma omp atomic
+                        ++compartidos[j];
+                    }
+                    if (usa_lista) {
+                        recordPair(ws, i, j);
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            if (mio != nullptr) {
+                mio[i] += propios;
+            } else {
+#pragma omp atomic
+                compartidos[i] += propios;
+            }
+        };
+
+#pragma omp for schedule(static) nowait
+        for (std::size_t k = 0; k < mitades; ++k) {
+            contarFila(k);
+            if (n - 1 - k != k) {
+                contarFila(n - 1 - k);
+            }
+        }
+    }
+
+    if (privados != nullptr) {
+        reducePrivateCounts(ws, n);
+    }
+}
+
+// P2: todos los mosaicos (bi, bj) con bj >= bi en una sola lista; cada uno cuesta lo
+// mismo (los diagonales la mitad), así que el reparto no depende de la fila. Los
+// mosaicos con omitir(bi, bj) no se recorren. Cada mosaico cuenta en buffers locales
+// del hilo (ws.locales) y los descarga una vez. Devuelve los pares evaluados.
+template <typename Mascara, typename Omitir>
+double countPairsByTiles(std::size_t n, std::size_t block_size, Workspace& ws, int* privados,
+                         Mascara&& mascara, Omitir&& omitir) {
+    const std::size_t block_count = (n + block_size - 1) / block_size;
+    const std::size_t hilos = static_cast<std::size_t>(omp_get_max_threads());
+    if (ws.locales.size() < 2 * hilos) {
+        ws.locales.resize(2 * hilos);
+    }
+    int* compartidos = ws.vecinos.data();
+    const bool usa_lista = ws.usa_lista;
+
+    // Fila del mosaico t en el triángulo superior: la fila bi empieza en inicio_fila[bi].
+    std::vector<std::size_t> inicio_fila(block_count + 1, 0);
+    for (std::size_t bi = 0; bi < block_count; ++bi) {
+        inicio_fila[bi + 1] = inicio_fila[bi] + (block_count - bi);
+    }
+    const std::size_t tiles = inicio_fila[block_count];
+
+    double pares = 0.0;
+#pragma omp parallel reduction(+ : pares)
+    {
+        BusyTimer ocupado(ws.perf.conteo);
+        const std::size_t tid = static_cast<std::size_t>(omp_get_thread_num());
+        std::vector<int>& local_i = ws.locales[2 * tid];
+        std::vector<int>& local_j = ws.locales[2 * tid + 1];
+        int* mio = privados != nullptr ? privados + tid * n : nullptr;
+
+        // Sin conteos privados se vuelve a la descarga atómica por mosaico.
+        auto descargar = [&](const std::vector<int>& local, std::size_t begin, std::size_t len) {
+            for (std::size_t offset = 0; offset < len; ++offset) {
+                const int value = local[offset];
+                if (value == 0) {
+                    continue;
+                }
+                if (mio != nullptr) {
+                    mio[begin + offset] += value;
+                } else {
+#pragma omp atomic
+                    compartidos[begin + offset] += value;
+                }
+            }
+        };
+
+#pragma omp for schedule(dynamic, 1) nowait
+        for (std::size_t t = 0; t < tiles; ++t) {
+            const std::size_t bi = static_cast<std::size_t>(
+                std::upper_bound(inicio_fila.begin(), inicio_fila.end(), t) - inicio_fila.begin()) - 1;
+            const std::size_t bj = bi + (t - inicio_fila[bi]);
+            if (bj != bi && omitir(bi, bj)) {
+                continue;
+            }
+            const std::size_t i_begin = bi * block_size;
+            const std::size_t i_end = std::min(n, i_begin + block_size);
+            const std::size_t i_block = i_end - i_begin;
+            const std::size_t j_begin = bj * block_size;
+            const std::size_t j_end = std::min(n, j_begin + block_size);
+            const std::size_t j_block = j_end - j_begin;
+
+            local_i.assign(i_block, 0);
+            pares += bi == bj ? static_cast<double>(i_block) * static_cast<double>(i_block - 1) / 2.0
+                              : static_cast<double>(i_block) * static_cast<double>(j_block);
+
+            if (bi == bj) {
+                for (std::size_t ii = i_begin; ii < i_end; ++ii) {
+                    for (std::size_t j0 = ii + 1; j0 < i_end; j0 += 64) {
+                        const std::size_t len = std::min<std::size_t>(64, i_end - j0);
+                        std::uint64_t mask = mascara(ii, j0, len);
+                        local_i[ii - i_begin] += popcount64(mask);
+                        while (mask != 0) {
+                            const std::size_t jj = j0 + lowestBit64(mask);
+                            ++local_i[jj - i_begin];
+                            if (usa_lista) {
+                                recordPair(ws, ii, jj);
+                            }
+                            mask &= mask - 1;
+                        }
+                    }
+                }
+            } else {
+                local_j.assign(j_block, 0);
+                for (std::size_t ii = i_begin; ii < i_end; ++ii) {
+                    for (std::size_t j0 = j_begin; j0 < j_end; j0 += 64) {
+                        const std::size_t len = std::min<std::size_t>(64, j_end - j0);
+                        std::uint64_t mask = mascara(ii, j0, len);
+                        local_i[ii - i_begin] += popcount64(mask);
+                        while (mask != 0) {
+                            const std::size_t jj = j0 + lowestBit64(mask);
+                            ++local_j[jj - j_begin];
+                            if (usa_lista) {
+                                recordPair(ws, ii, jj);
+                            }
+                            mask &= mask - 1;
+                        }
+                    }
+                }
+                descargar(local_j, j_begin, j_block);
+            }
+
+            descargar(local_i, i_begin, i_block);
+        }
+    }
+
+    if (privados != nullptr) {
+        reducePrivateCounts(ws, n);
+    }
+    return pares;
+}
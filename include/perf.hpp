@@ -0,0 +1,92 @@
+#pragma once
+
+#include <omp.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Contadores de hardware por hilo con perf_event_open (Linux). Si el sistema no los
+// permite (kernel.perf_event_paranoid, contenedores, otro SO) las lecturas quedan
+// marcadas como no válidas y solo se reportan los tiempos ocupado/ocioso.
+enum PerfEvent {
+    PERF_CICLOS,
+    PERF_INSTRUCCIONES,
+    PERF_FALLOS_LLC,
+    PERF_FALLOS_RAMA,
+    PERF_EVENTOS,
+};
+
+// Nombre del evento para columnas y JSON ("cycles", "instructions", ...).
+const char* perfEventName(int evento);
+
+struct PerfCounts {
+    std::uint64_t valores[PERF_EVENTOS] = {};
+    bool valido[PERF_EVENTOS] = {};
+
+    PerfCounts& operator+=(const PerfCounts& otro);
+
+    bool any() const;
+    // Instrucciones por ciclo, negativo si falta alguno de los dos contadores.
+    double ipc() const;
+};
+
+// Una fase de una corrida: contadores por hilo (índice omp_get_thread_num) y, si el
+// motor lo mide, el tiempo que cada hilo pasó haciendo trabajo de la fase.
+struct PhasePerf {
+    std::vector<PerfCounts> hilos;
+    std::vector<double> ocupado;  // vacío si la fase no se midió por hilo
+    double pared = 0.0;
+
+    PerfCounts total() const;
+    // Deja ocupado en cero para `hilos` hilos; lo llaman los motores antes del bucle.
+    void prepareBusy(std::size_t hilos);
+    double busyMax() const;
+    double busyMean() const;
+    // Fracción del tiempo de los hilos que no fue trabajo: 1 - suma(ocupado) / (hilos * pared).
+    double idleFraction() const;
+};
+
+// Contadores de la última corrida de un motor, con las mismas fases que PhaseTimes.
+struct PerfReport {
+    bool activo = false;
+    std::uint64_t ronda = 0;
+    PhasePerf preparacion;
+    PhasePerf conteo;
+    PhasePerf cores;
+    PhasePerf frontera;
+};
+
+// true si el hilo que llama pudo abrir al menos un contador.
+bool perfCountersAvailable();
+
+// DBSCAN_PERF definida y distinta de "0".
+bool perfRequested();
+
+// Empieza una corrida: limpia las fases y toma la lectura base de cada hilo del equipo.
+void perfBegin(PerfReport& perf);
+
+// Cierra una fase: lee los contadores de cada hilo del equipo y guarda la diferencia
+// con su lectura anterior. Un hilo sin lectura base en esta corrida aporta cero.
+void perfLap(PerfReport& perf, PhasePerf& fase, double pared);
+
+// Suma al hilo actual el tiempo entre su construcción y su destrucción. No hace nada
+// si la fase no se preparó con prepareBusy.
+class BusyTimer {
+public:
+    explicit BusyTimer(PhasePerf& fase) : fase_(fase), inicio_(omp_get_wtime()) {}
+
+    ~BusyTimer() {
+        const std::size_t tid = static_cast<std::size_t>(omp_get_thread_num());
+        if (tid < fase_.ocupado.size()) {
+            fase_.ocupado[tid] += omp_get_wtime() - inicio_;
+        }
+    }
+
+    BusyTimer(const BusyTimer&) = delete;
+    BusyTimer& operator=(const BusyTimer&) = delete;
+
+private:
+    PhasePerf& fase_;
+    double inicio_;
+};
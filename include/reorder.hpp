@@ -0,0 +1,43 @@
+#pragma once
+
+#include "dbscan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Curva de llenado del espacio con que se ordenan los puntos antes de etiquetar.
+enum class Curve {
+    Ninguna,
+    Morton,
+    Hilbert,
+};
+
+const char* curveName(Curve curva);
+
+// Devuelve false si el nombre no corresponde a ninguna curva.
+bool parseCurve(const std::string& nombre, Curve& curva);
+
+// Curva pedida en la variable de entorno DBSCAN_CURVE (morton|hilbert); Ninguna si
+// no está o no se reconoce.
+Curve curveRequested();
+
+// Permutación de los puntos a lo largo de una curva, con los buffers del radix sort
+// para reutilizarlos entre llamadas.
+struct SpatialOrder {
+    std::vector<std::size_t> orden;  // orden[k] = índice original del k-ésimo punto de la curva
+    std::vector<std::uint32_t> claves;
+    std::vector<std::uint32_t> claves_aux;
+    std::vector<std::size_t> orden_aux;
+    std::vector<std::size_t> histograma;  // 256 por hilo
+};
+
+// Clave de 32 bits de (x, y) cuantizados a 16 bits por eje dentro de la caja envolvente.
+std::uint32_t mortonKey(std::uint32_t x, std::uint32_t y);
+std::uint32_t hilbertKey(std::uint32_t x, std::uint32_t y);
+
+// Calcula las claves en paralelo y las ordena con un radix sort LSD paralelo (cuatro
+// pasadas de 8 bits, histogramas por hilo). Es estable: puntos con la misma clave
+// conservan su orden relativo, así que el resultado no depende del número de hilos.
+void buildSpatialOrder(const std::vector<Point>& puntos, Curve curva, SpatialOrder& orden);
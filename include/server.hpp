@@ -0,0 +1,106 @@
+#pragma once
+
+#include "clusterer.hpp"
+#include "dbscan.hpp"
+#include "reorder.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bytes por punto que se cuentan contra el presupuesto del cache: los puntos, la
+// permutación de la curva y los buffers del Clusterer de ese conjunto.
+constexpr std::size_t SERVER_BYTES_POR_PUNTO = 128;
+
+struct ServerOptions {
+    std::string socket;
+    std::size_t memoria = std::size_t{4} << 30;  // presupuesto del cache en bytes
+    int num_threads = 0;
+    Engine engine = Engine::Grid;   // motor si la solicitud no indica otro
+    Curve curva = Curve::Hilbert;   // orden en que se guardan los puntos
+};
+
+// Conjunto de datos residente: los puntos ya ordenados por la curva, la permutación
+// para volver al orden del archivo y un Clusterer que conserva sus buffers.
+struct CachedDataset {
+    std::string ruta;
+    std::int64_t modificado = 0;  // marca de modificación del archivo al cargarlo
+    std::vector<Point> puntos;    // en orden de la curva
+    std::vector<std::size_t> orden;  // orden[k] = posición en el archivo del punto k
+    Clusterer clusterer;
+    std::size_t bytes = 0;
+    std::size_t usos = 0;
+
+    // Puntos con sus etiquetas en el orden del archivo.
+    std::vector<Point> inFileOrder() const;
+};
+
+// Cache LRU de conjuntos por ruta con presupuesto de memoria. Al cargar uno nuevo se
+// descartan los menos usados recientemente hasta volver al presupuesto (nunca el
+// recién cargado, aunque solo él lo exceda).
+class DatasetCache {
+public:
+    explicit DatasetCache(std::size_t memoria, Curve curva = Curve::Hilbert);
+
+    // Devuelve el conjunto de `ruta`, cargándolo si no está o si el archivo cambió
+    // desde que se cargó. `acierto` indica si se sirvió sin leer. nullptr si no se
+    // pudo leer.
+    CachedDataset* acquire(const std::string& ruta, bool& acierto);
+    bool drop(const std::string& ruta);
+
+    std::size_t size() const { return indice_.size(); }
+    std::size_t bytes() const { return bytes_; }
+    std::size_t budget() const { return memoria_; }
+
+    // Una línea por conjunto, del más reciente al más viejo.
+    void describe(std::ostream& out) const;
+
+private:
+    using Lista = std::list<std::unique_ptr<CachedDataset>>;
+
+    void evict();
+
+    std::size_t memoria_;
+    Curve curva_;
+    std::size_t bytes_ = 0;
+    Lista lru_;  // frente = usado más recientemente
+    std::unordered_map<std::string, Lista::iterator> indice_;
+};
+
+// Servidor sobre un socket Unix. Protocolo de texto, una solicitud por línea y una
+// respuesta por línea ("ok ..." o "error ..."):
+//   cluster <ruta> <eps> <min_samples> [motor] [salida]  etiqueta el conjunto; con
+//       salida además calcula los clusters (assignClusters), los guarda en el cache
+//       y escribe label y cluster en el orden del archivo (.bin o CSV)
+//   load <ruta>       carga sin etiquetar        drop <ruta>   lo quita del cache
+//   stats             conjuntos, memoria y aciertos del cache
+//   shutdown          termina el servidor
+// Las conexiones se atienden de a una; cada solicitud usa todos los hilos.
+class DBSCANServer {
+public:
+    explicit DBSCANServer(const ServerOptions& opciones);
+
+    // Atiende una solicitud y devuelve la respuesta, sin salto de línea.
+    std::string handle(const std::string& linea);
+    bool running() const { return activo_; }
+
+    // Escucha en opciones.socket hasta recibir shutdown. Devuelve false si no pudo
+    // abrir el socket.
+    bool serve(std::ostream& registro);
+
+private:
+    ServerOptions opciones_;
+    DatasetCache cache_;
+    bool activo_ = true;
+    std::size_t solicitudes_ = 0;
+    std::size_t aciertos_ = 0;
+};
+
+// Cliente: envía las solicitudes (una por línea) y devuelve las respuestas. false si
+// no se pudo conectar.
+bool sendRequests(const std::string& socket, const std::vector<std::string>& lineas, std::vector<std::string>& respuestas);
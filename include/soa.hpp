@@ -0,0 +1,114 @@
+#pragma once
+
+#include "dbscan.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Reservador alineado a línea de caché (y a registro AVX-512) para los arreglos SoA.
+template <typename T, std::size_t Alineacion = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alineacion>&) {}
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alineacion>;
+    };
+
+    T* allocate(std::size_t n) {
+        const std::size_t bytes = ((n * sizeof(T) + Alineacion - 1) / Alineacion) * Alineacion;
+        void* p = std::aligned_alloc(Alineacion, bytes == 0 ? Alineacion : bytes);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t) { std::free(p); }
+
+    // resize sin valor no inicializa: la primera escritura la hace el bucle paralelo
+    // que llena el SoA (ver FirstTouchAllocator en numa.hpp).
+    template <typename U>
+    void construct(U* p) noexcept {
+        ::new (static_cast<void*>(p)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alineacion>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alineacion>&) const { return false; }
+};
+
+using AlignedDoubles = std::vector<double, AlignedAllocator<double>>;
+
+// Puntos en formato estructura-de-arreglos: x[] e y[] contiguos y alineados.
+struct PointsSoA {
+    AlignedDoubles x;
+    AlignedDoubles y;
+
+    std::size_t size() const { return x.size(); }
+    void assign(const std::vector<Point>& puntos);
+    // Copia únicamente los puntos con etiqueta CORE1, en el orden original.
+    void assignCores(const std::vector<Point>& puntos);
+};
+
+// Distancia al cuadrado a partir de las diferencias. Todas las rutas (escalares y
+// SIMD) la evalúan igual para que los empates exactamente en epsilon coincidan.
+inline double squaredNorm(double dx, double dy) {
+#ifdef __FMA__
+    return std::fma(dx, dx, dy * dy);
+#else
+    return dx * dx + dy * dy;
+#endif
+}
+
+// Caja envolvente de un bloque de puntos consecutivos.
+struct Caja {
+    double min_x, max_x, min_y, max_y;
+};
+
+// Distancia^2 mínima entre dos cajas (0 si se tocan o se solapan).
+inline double boxGapSquared(const Caja& a, const Caja& b) {
+    const double dx = std::max({0.0, a.min_x - b.max_x, b.min_x - a.max_x});
+    const double dy = std::max({0.0, a.min_y - b.max_y, b.min_y - a.max_y});
+    return squaredNorm(dx, dy);
+}
+
+// cajas[b] = caja de los puntos [b * block_size, (b + 1) * block_size) del SoA, en
+// paralelo sobre los bloques. Dos bloques con cajas a más de epsilon no tienen pares
+// vecinos; con los puntos en orden espacial (reorder.hpp) casi todos los mosaicos lo son.
+void blockBoxes(const PointsSoA& soa, std::size_t block_size, std::vector<Caja>& cajas);
+
+// Núcleos por lotes: comparan el punto (px, py) contra count candidatos.
+// maskWithin admite como máximo 64 candidatos y devuelve el bit k encendido si
+// el candidato k está a distancia <= sqrt(eps2).
+std::size_t countWithin(double px, double py, const double* xs, const double* ys, std::size_t count, double eps2);
+
+std::uint64_t maskWithin(double px, double py, const double* xs, const double* ys, std::size_t count, double eps2);
+
+bool anyWithin(double px, double py, const double* xs, const double* ys, std::size_t count, double eps2);
+
+// Nombre del conjunto de instrucciones con que se compilaron los núcleos.
+const char* simdKernelName();
+
+inline int popcount64(std::uint64_t mask) {
+    return __builtin_popcountll(mask);
+}
+
+inline int lowestBit64(std::uint64_t mask) {
+    return __builtin_ctzll(mask);
+}
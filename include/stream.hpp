@@ -0,0 +1,68 @@
+#pragma once
+
+#include "dbscan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// DBSCAN incremental: conserva conteos de vecinos y etiquetas entre lotes. Insertar o
+// expirar puntos solo recalcula los conteos de sus vecinos y las etiquetas del
+// vecindario tocado, en vez de volver a recorrer los n² pares.
+//
+// Los puntos se identifican por su orden de llegada. Con ventana > 0 solo se
+// conservan los últimos `ventana` puntos; los más viejos expiran al insertar.
+class StreamingDBSCAN {
+public:
+    StreamingDBSCAN(double epsilon, int min_samples, std::size_t ventana = 0);
+
+    // Resumen de un lote: puntos agregados y expirados y etiquetas recalculadas.
+    struct Cambios {
+        std::size_t insertados = 0;
+        std::size_t expirados = 0;
+        std::size_t reetiquetados = 0;
+    };
+
+    Cambios insert(const std::vector<Point>& lote);
+    Cambios expireOldest(std::size_t cuantos);
+
+    std::size_t size() const { return puntos_.size() - inicio_; }
+    std::size_t cores() const { return cores_; }
+    std::size_t noise() const { return ruido_; }
+
+    // Puntos activos en orden de llegada, con label actualizado (cluster queda NOISE).
+    std::vector<Point> snapshot() const;
+
+private:
+    std::uint64_t cellKey(double x, double y) const;
+
+    // Llama f(id) con cada punto activo en el vecindario 3x3 de (x, y), incluido el
+    // propio punto si está en la grilla.
+    template <typename F>
+    void forEachCandidate(double x, double y, F&& f) const;
+
+    // Recalcula las etiquetas de `afectados` (ids ya marcados en tocados_) y de los
+    // vecinos de los que cambian de core a no core o al revés. Devuelve cuántos revisó.
+    std::size_t relabel(std::vector<std::size_t>& afectados);
+
+    Point& at(std::size_t id) { return puntos_[id - base_]; }
+    const Point& at(std::size_t id) const { return puntos_[id - base_]; }
+
+    double eps2_;
+    double cell_;
+    int min_samples_;
+    std::size_t ventana_;
+
+    // puntos_[id - base_] para ids en [base_ + inicio_, base_ + puntos_.size()).
+    // Los expirados se quedan al frente hasta que ocupan la mitad del arreglo.
+    std::vector<Point> puntos_;
+    std::vector<int> vecinos_;
+    std::vector<char> tocados_;
+    std::size_t base_ = 0;
+    std::size_t inicio_ = 0;
+    std::size_t cores_ = 0;
+    std::size_t ruido_ = 0;
+
+    std::unordered_map<std::uint64_t, std::vector<std::size_t>> celdas_;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "dbscan.hpp"
+#include "grid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Vecinos de cada punto hasta eps_max, ordenados por distancia. Se calcula una vez y
+// de él sale el etiquetado de cualquier (eps <= eps_max, min_samples) sin volver a
+// recorrer pares. Todo está en el orden de celda de `grid`.
+struct NeighborProfile {
+    double eps_max = 0.0;
+    GridIndex grid;
+    std::vector<std::size_t> inicio;  // vecinos de p en [inicio[p], inicio[p + 1]) (n + 1)
+    std::vector<double> distancias;   // distancia^2, creciente dentro de cada punto
+    std::vector<int> indices;         // posición del vecino en el orden de celda
+
+    std::size_t size() const { return inicio.empty() ? 0 : inicio.size() - 1; }
+    std::size_t pairs() const { return distancias.size(); }
+};
+
+// Construye el perfil en paralelo: un conteo sobre la grilla de lado eps_max para
+// dimensionar, y un llenado donde cada punto escribe y ordena su propio tramo.
+// Ocupa 12 bytes por par vecino, así que eps_max no debería ser mucho mayor que el
+// mayor eps de interés.
+void buildNeighborProfile(const std::vector<Point>& puntos, double eps_max, NeighborProfile& perfil);
+
+// Una configuración del barrido y su resultado.
+struct SweepResult {
+    double epsilon = 0.0;
+    int min_samples = 0;
+    std::size_t cores = 0;
+    std::size_t frontera = 0;
+    std::size_t ruido = 0;
+    double tiempo = 0.0;
+};
+
+// Etiqueta todas las combinaciones de `epsilons` x `mins` sobre el perfil. Un punto es
+// core si su vecino número min_samples está a distancia <= eps (una lectura por
+// punto), y frontera si alguno de sus vecinos a menos de eps es core. Si `etiquetas`
+// no es nulo recibe configuraciones x n etiquetas en el orden original de los puntos,
+// en el mismo orden que el resultado (eps externo, min_samples interno).
+// Con eps > eps_max del perfil la configuración se omite.
+std::vector<SweepResult> sweepLabels(const NeighborProfile& perfil,
+                                     const std::vector<double>& epsilons,
+                                     const std::vector<int>& mins,
+                                     std::vector<std::int8_t>* etiquetas = nullptr);
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "clusterer.hpp"
+#include "dbscan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Puntos cuya etiqueta difiere entre a y b (el tamaño mayor si no coinciden).
+std::size_t countMismatches(const std::vector<Point>& a, const std::vector<Point>& b);
+
+// Un conjunto de prueba con los parámetros con que se etiqueta.
+struct VerifyCase {
+    std::string nombre;
+    std::vector<Point> puntos;
+    double epsilon = 0.0;
+    int min_samples = 0;
+};
+
+// Conjuntos de --verify: aleatorios de cada distribución con `count` puntos y casos
+// adversos (entrada vacía, un punto, duplicados justo en el umbral de min_samples,
+// todos en el mismo lugar, grillas con vecinos exactamente a distancia eps, un
+// cluster que lo cubre todo, solo ruido y puntos colineales).
+std::vector<VerifyCase> verifyCases(std::size_t count, std::uint64_t seed);
+
+struct VerifyOptions {
+    std::size_t count = 20000;
+    std::uint64_t seed = 208450;
+    std::vector<int> hilos;  // vacío = 1, 2 y omp_get_max_threads()
+    double umbral = 0.25;    // regresión: más lento que la base en esta fracción
+    std::string base;        // archivo de tiempos de referencia; vacío = sin tiempos
+    bool actualizar = false; // reescribe la base con los tiempos medidos; nunca implícito
+};
+
+struct VerifyReport {
+    std::size_t corridas = 0;
+    std::size_t diferencias = 0;  // corridas con alguna etiqueta distinta de la serial
+    std::size_t regresiones = 0;
+    std::size_t sin_base = 0;     // corridas sin tiempo de referencia (con base y sin actualizar)
+
+    bool ok() const { return diferencias == 0 && regresiones == 0 && sin_base == 0; }
+};
+
+// DBSCAN_BASELINE si está definida; si no, data/results/verify.baseline.
+std::string defaultBaselinePath();
+
+// Prueba diferencial: cada caso se etiqueta con el motor serial de un hilo y luego con
+// cada motor, número de hilos, curva (ninguna, hilbert) y, en P2 y tareas, un bloque
+// pequeño que parte los mosaicos en lugares incómodos. Todas las etiquetas deben ser
+// idénticas a las seriales; también dbscan_approx con rho = 0, el barrido de un
+// perfil de vecinos, los clusters de cada número de hilos contra un BFS de
+// referencia, StreamingDBSCAN (en lotes y con ventana), las plantillas de
+// dbscan_nd.hpp con D = 2 y dbscan_out_of_core con un presupuesto que fuerza varias
+// particiones.
+//
+// Los tiempos (mínimo de varias repeticiones) se comparan con los de la base, que es
+// un archivo clave=valor marcado con el modelo de CPU: una corrida es regresión si
+// tarda más de (1 + umbral) veces su base más un margen fijo para los casos de
+// milisegundos. Una base de otra CPU o de otros casos se ignora. Sin `actualizar`, una
+// corrida sin tiempo en la base (o sin base utilizable) cuenta en sin_base y el
+// reporte no es ok; con `actualizar` no se compara y la base se reescribe.
+VerifyReport verifyEngines(const VerifyOptions& opciones, std::ostream& log);
@@ -0,0 +1,190 @@
+#include "approx.hpp"
+#include "grid.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using std::size_t;
+
+namespace {
+
+// Distancias^2 mínima y máxima de (px, py) a la caja de la celda (col, row).
+struct CajaDistancias {
+    double min2;
+    double max2;
+};
+
+CajaDistancias boxDistances(const GridIndex& grid, size_t col, size_t row, double px, double py) {
+    const double x0 = grid.min_x + static_cast<double>(col) * grid.cell;
+    const double y0 = grid.min_y + static_cast<double>(row) * grid.cell;
+    const double x1 = x0 + grid.cell;
+    const double y1 = y0 + grid.cell;
+    const double dx_min = std::max({0.0, x0 - px, px - x1});
+    const double dy_min = std::max({0.0, y0 - py, py - y1});
+    const double dx_max = std::max(px - x0, x1 - px);
+    const double dy_max = std::max(py - y0, y1 - py);
+    return {squaredNorm(dx_min, dy_min), squaredNorm(dx_max, dy_max)};
+}
+
+}  // namespace
+
+void dbscan_approx(std::vector<Point>& puntos,
+                   double epsilon,
+                   int min_samples,
+                   const ApproxOptions& opciones,
+                   int num_threads,
+                   Workspace& ws) {
+    PhaseClock reloj(ws.perf);
+    ws.fases = PhaseTimes{};
+    resetLabels(puntos);
+    const size_t n = puntos.size();
+    if (n == 0) {
+        return;
+    }
+
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+
+    const double eps2 = epsilon * epsilon;
+    const double rho = std::max(0.0, opciones.rho);
+    // Una caja entera dentro de este radio se cuenta completa sin medir distancias.
+    const double holgura2 = eps2 * (1.0 + rho) * (1.0 + rho);
+    const bool muestrear = rho > 0.0 && opciones.muestra > 0;
+
+    // Con lado eps/2 la diagonal de una celda (~0.71·eps) queda dentro de eps; si
+    // buildGrid agranda la celda para acotar la grilla se amplía el alcance.
+    buildGrid(puntos, epsilon * 0.5, ws.grid);
+    const GridIndex& grid = ws.grid;
+    const size_t celdas = grid.cols * grid.rows;
+    const size_t alcance = static_cast<size_t>(epsilon / grid.cell) + 1;
+
+    FirstTouchVector<int>& vecinos = ws.vecinos;
+    firstTouchAssign(vecinos, n, 0);
+    FirstTouchVector<char>& es_core = ws.es_core;
+    firstTouchAssign(es_core, n, char{0});
+    ws.fases.preparacion = reloj.lap(ws.perf.preparacion);
+
+    // Visita las celdas del vecindario de c en orden hasta que f devuelva true.
+    auto forEachNearCell = [&](size_t c, auto&& f) {
+        const size_t col = grid.cellCol(c);
+        const size_t row = grid.cellRow(c);
+        const size_t col_ini = col > alcance ? col - alcance : 0;
+        const size_t col_fin = std::min(grid.cols - 1, col + alcance);
+        const size_t row_ini = row > alcance ? row - alcance : 0;
+        const size_t row_fin = std::min(grid.rows - 1, row + alcance);
+        for (size_t r = row_ini; r <= row_fin; ++r) {
+            for (size_t k = col_ini; k <= col_fin; ++k) {
+                if (f(k, r, r * grid.cols + k)) {
+                    return;
+                }
+            }
+        }
+    };
+
+    const size_t objetivo = static_cast<size_t>(std::max(min_samples, 0));
+    double pares = 0.0;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+ : pares)
+    for (size_t c = 0; c < celdas; ++c) {
+        for (size_t p = grid.inicio[c]; p < grid.inicio[c + 1]; ++p) {
+            const double px = grid.xs[p];
+            const double py = grid.ys[p];
+            size_t cuenta = 0;
+            forEachNearCell(c, [&](size_t col, size_t row, size_t vecina) {
+                const size_t q_ini = grid.inicio[vecina];
+                const size_t q_fin = grid.inicio[vecina + 1];
+                const size_t tam = q_fin - q_ini;
+                if (tam == 0) {
+                    return false;
+                }
+                const CajaDistancias caja = boxDistances(grid, col, row, px, py);
+                if (caja.min2 > eps2) {
+                    return false;
+                }
+                // En la propia celda p cuenta a distancia 0 y se descuenta.
+                const size_t propio = vecina == c ? 1 : 0;
+                if (caja.max2 <= holgura2) {
+                    cuenta += tam - propio;
+                } else if (muestrear && propio == 0 && tam > opciones.muestra) {
+                    const size_t paso = (tam + opciones.muestra - 1) / opciones.muestra;
+                    size_t dentro = 0;
+                    size_t medidos = 0;
+                    for (size_t q = q_ini; q < q_fin; q += paso, ++medidos) {
+                        dentro += squaredNorm(px - grid.xs[q], py - grid.ys[q]) <= eps2;
+                    }
+                    pares += static_cast<double>(medidos);
+                    cuenta += dentro * tam / medidos;
+                } else {
+                    cuenta += countWithin(px, py, &grid.xs[q_ini], &grid.ys[q_ini], tam, eps2) - propio;
+                    pares += static_cast<double>(tam);
+                }
+                return cuenta >= objetivo;
+            });
+            vecinos[p] = static_cast<int>(std::min(cuenta, objetivo));
+        }
+    }
+    ws.fases.conteo = reloj.lap(ws.perf.conteo);
+    ws.fases.pares = pares;
+
+    // Celdas con algún core: la frontera descarta de entrada las que no tienen.
+    std::vector<char> con_core(celdas, 0);
+#pragma omp parallel for schedule(static)
+    for (size_t c = 0; c < celdas; ++c) {
+        for (size_t p = grid.inicio[c]; p < grid.inicio[c + 1]; ++p) {
+            if (vecinos[p] >= min_samples) {
+                es_core[p] = 1;
+                con_core[c] = 1;
+                puntos[grid.orden[p]].label = CORE1;
+            }
+        }
+    }
+    ws.fases.cores = reloj.lap(ws.perf.cores);
+
+#pragma omp parallel for schedule(dynamic, 16)
+    for (size_t c = 0; c < celdas; ++c) {
+        for (size_t p = grid.inicio[c]; p < grid.inicio[c + 1]; ++p) {
+            if (es_core[p]) {
+                continue;
+            }
+            const double px = grid.xs[p];
+            const double py = grid.ys[p];
+            bool frontera = false;
+            forEachNearCell(c, [&](size_t col, size_t row, size_t vecina) {
+                if (!con_core[vecina]) {
+                    return false;
+                }
+                const CajaDistancias caja = boxDistances(grid, col, row, px, py);
+                if (caja.min2 > eps2) {
+                    return false;
+                }
+                if (caja.max2 <= holgura2) {
+                    frontera = true;
+                } else {
+                    for (size_t q = grid.inicio[vecina]; q < grid.inicio[vecina + 1] && !frontera; ++q) {
+                        frontera = es_core[q] && squaredNorm(px - grid.xs[q], py - grid.ys[q]) <= eps2;
+                    }
+                }
+                return frontera;
+            });
+            if (frontera) {
+                puntos[grid.orden[p]].label = CORE2;
+            }
+        }
+    }
+    ws.fases.frontera = reloj.lap(ws.perf.frontera);
+}
+
+std::vector<Point> dbscan_approx(const std::string& ruta,
+                                 double epsilon,
+                                 int min_samples,
+                                 const ApproxOptions& opciones,
+                                 int num_threads) {
+    std::vector<Point> puntos = loadPoints(ruta);
+    Workspace ws;
+    dbscan_approx(puntos, epsilon, min_samples, opciones, num_threads, ws);
+    return puntos;
+}
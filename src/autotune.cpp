@@ -0,0 +1,233 @@
+#include "autotune.hpp"
+
+#include <omp.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <set>
+
+using std::size_t;
+
+namespace {
+
+// Bytes por punto dentro de un mosaico: x e y en double más su conteo local.
+constexpr size_t BYTES_POR_PUNTO = 2 * sizeof(double) + sizeof(int);
+
+constexpr int REPETICIONES = 3;
+
+size_t cacheSize(int nombre, size_t defecto) {
+    const long valor = sysconf(nombre);
+    return valor > 0 ? static_cast<size_t>(valor) : defecto;
+}
+
+size_t floorPow2(size_t v) {
+    size_t p = 1;
+    while (p * 2 <= v) {
+        p *= 2;
+    }
+    return p;
+}
+
+std::string trim(const std::string& texto) {
+    const size_t ini = texto.find_first_not_of(" \t\r");
+    const size_t fin = texto.find_last_not_of(" \t\r");
+    return ini == std::string::npos ? "" : texto.substr(ini, fin - ini + 1);
+}
+
+// Submuestra ordenada por índice: conserva el orden relativo de la entrada, que
+// importa para los motores que podan mosaicos por caja envolvente.
+std::vector<Point> samplePoints(const std::vector<Point>& puntos, size_t muestra) {
+    if (puntos.size() <= muestra) {
+        return puntos;
+    }
+    std::vector<size_t> indices(puntos.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = i;
+    }
+    std::mt19937_64 rng(12345);
+    for (size_t k = 0; k < muestra; ++k) {
+        std::uniform_int_distribution<size_t> dist(k, indices.size() - 1);
+        std::swap(indices[k], indices[dist(rng)]);
+    }
+    indices.resize(muestra);
+    std::sort(indices.begin(), indices.end());
+
+    std::vector<Point> salida;
+    salida.reserve(muestra);
+    for (size_t i : indices) {
+        salida.push_back(puntos[i]);
+    }
+    return salida;
+}
+
+bool usesBlockSize(Engine engine) {
+    return engine == Engine::ParallelDivided || engine == Engine::ParallelTasks;
+}
+
+}
+
+std::string defaultProfilePath() {
+    const char* entorno = std::getenv("DBSCAN_PROFILE");
+    return entorno != nullptr && *entorno != '\0' ? entorno : "data/results/autotune.profile";
+}
+
+std::string cpuModel() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string linea;
+    while (std::getline(in, linea)) {
+        if (linea.rfind("model name", 0) == 0) {
+            const size_t dos_puntos = linea.find(':');
+            if (dos_puntos != std::string::npos) {
+                return trim(linea.substr(dos_puntos + 1));
+            }
+        }
+    }
+    return "desconocido";
+}
+
+bool saveProfile(const std::string& ruta, const TuningProfile& perfil) {
+    const std::filesystem::path padre = std::filesystem::path(ruta).parent_path();
+    if (!padre.empty()) {
+        std::filesystem::create_directories(padre);
+    }
+    std::ofstream out(ruta);
+    if (!out) {
+        return false;
+    }
+    out << "cpu=" << perfil.cpu << '\n'
+        << "engine=" << engineName(perfil.engine) << '\n'
+        << "threads=" << perfil.num_threads << '\n'
+        << "block_size=" << perfil.block_size << '\n';
+    return static_cast<bool>(out);
+}
+
+bool loadProfile(const std::string& ruta, TuningProfile& perfil) {
+    std::ifstream in(ruta);
+    if (!in) {
+        return false;
+    }
+    TuningProfile leido;
+    std::string linea;
+    try {
+        while (std::getline(in, linea)) {
+            const size_t igual = linea.find('=');
+            if (igual == std::string::npos) {
+                continue;
+            }
+            const std::string clave = trim(linea.substr(0, igual));
+            const std::string valor = trim(linea.substr(igual + 1));
+            if (clave == "cpu") {
+                leido.cpu = valor;
+            } else if (clave == "engine") {
+                if (!parseEngine(valor, leido.engine)) {
+                    return false;
+                }
+            } else if (clave == "threads") {
+                leido.num_threads = std::stoi(valor);
+            } else if (clave == "block_size") {
+                leido.block_size = static_cast<size_t>(std::stoul(valor));
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (leido.cpu != cpuModel() || leido.block_size == 0) {
+        return false;
+    }
+    perfil = leido;
+    return true;
+}
+
+std::vector<size_t> candidateBlockSizes() {
+    const size_t l1 = cacheSize(_SC_LEVEL1_DCACHE_SIZE, size_t{32} << 10);
+    const size_t l2 = cacheSize(_SC_LEVEL2_CACHE_SIZE, size_t{1} << 20);
+
+    std::set<size_t> candidatos;
+    for (size_t cache : {l1, l2}) {
+        const size_t base = floorPow2(std::max<size_t>(64, cache / (2 * BYTES_POR_PUNTO)));
+        for (size_t b : {base / 2, base, base * 2}) {
+            candidatos.insert(std::clamp<size_t>(b, 64, 16384));
+        }
+    }
+    return {candidatos.begin(), candidatos.end()};
+}
+
+TuningProfile autotune(const std::vector<Point>& puntos, double epsilon, int min_samples, size_t muestra, std::ostream& log) {
+    std::vector<Point> base = samplePoints(puntos, std::max<size_t>(muestra, 1));
+    // En 2D el número esperado de vecinos escala con n * eps²: ajustar eps mantiene
+    // la densidad de la muestra parecida a la del conjunto completo.
+    const double eps_muestra = puntos.empty()
+        ? epsilon
+        : epsilon * std::sqrt(static_cast<double>(puntos.size()) / static_cast<double>(base.size()));
+
+    const int cores = omp_get_num_procs();
+    std::set<int> hilos_set = {1, std::max(1, cores / 2), cores, cores * 2};
+    const std::vector<int> hilos(hilos_set.begin(), hilos_set.end());
+    const std::vector<size_t> bloques = candidateBlockSizes();
+    const std::vector<Engine> engines = {
+        Engine::ParallelFull, Engine::ParallelDivided, Engine::ParallelTasks, Engine::Grid, Engine::KdTree};
+
+    log << "Muestra: " << base.size() << " de " << puntos.size() << " puntos  eps muestra: " << eps_muestra << '\n'
+        << "Bloques candidatos:";
+    for (size_t b : bloques) {
+        log << ' ' << b;
+    }
+    log << "\n\n";
+
+    TuningProfile mejor;
+    mejor.cpu = cpuModel();
+    double mejor_tiempo = -1.0;
+    // El bloque del perfil es el del mejor motor por mosaicos aunque gane otro motor,
+    // para que P2 y las tareas lo usen cuando se elijan a mano.
+    double mejor_tiempo_bloque = -1.0;
+    std::vector<Point> trabajo = base;
+    std::vector<double> tiempos;
+
+    for (Engine engine : engines) {
+        const std::vector<size_t> mis_bloques = usesBlockSize(engine) ? bloques : std::vector<size_t>{512};
+        for (int h : hilos) {
+            for (size_t b : mis_bloques) {
+                Clusterer clusterer(engine, h, b);
+                clusterer.run(trabajo, eps_muestra, min_samples);  // calentamiento
+
+                tiempos.clear();
+                for (int r = 0; r < REPETICIONES; ++r) {
+                    const double inicio = omp_get_wtime();
+                    clusterer.run(trabajo, eps_muestra, min_samples);
+                    tiempos.push_back(omp_get_wtime() - inicio);
+                    // Una configuración 3 veces más lenta que la mejor no necesita más medidas.
+                    if (mejor_tiempo > 0.0 && tiempos.back() > 3.0 * mejor_tiempo) {
+                        break;
+                    }
+                }
+                std::sort(tiempos.begin(), tiempos.end());
+                const double mediana = tiempos[tiempos.size() / 2];
+
+                log << std::fixed << std::setprecision(6) << "  " << std::left << std::setw(17) << engineName(engine)
+                    << std::right << " hilos " << std::setw(3) << h;
+                if (usesBlockSize(engine)) {
+                    log << "  bloque " << std::setw(5) << b;
+                }
+                log << "  " << mediana << " s\n";
+
+                if (mejor_tiempo < 0.0 || mediana < mejor_tiempo) {
+                    mejor_tiempo = mediana;
+                    mejor.engine = engine;
+                    mejor.num_threads = h;
+                }
+                if (usesBlockSize(engine) && (mejor_tiempo_bloque < 0.0 || mediana < mejor_tiempo_bloque)) {
+                    mejor_tiempo_bloque = mediana;
+                    mejor.block_size = b;
+                }
+            }
+        }
+    }
+    return mejor;
+}
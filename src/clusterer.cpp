@@ -0,0 +1,87 @@
+#include "clusterer.hpp"
+
+const char* engineName(Engine engine) {
+    switch (engine) {
+    case Engine::Serial:
+        return "serial";
+    case Engine::ParallelFull:
+        return "parallel_full";
+    case Engine::ParallelDivided:
+        return "parallel_divided";
+    case Engine::ParallelTasks:
+        return "parallel_tasks";
+    case Engine::Grid:
+        return "grid";
+    case Engine::KdTree:
+        return "kdtree";
+    }
+    return "desconocido";
+}
+
+bool parseEngine(const std::string& nombre, Engine& engine) {
+    for (Engine candidato : {Engine::Serial, Engine::ParallelFull, Engine::ParallelDivided, Engine::ParallelTasks, Engine::Grid, Engine::KdTree}) {
+        if (nombre == engineName(candidato)) {
+            engine = candidato;
+            return true;
+        }
+    }
+    return false;
+}
+
+Clusterer::Clusterer(Engine engine, int num_threads, std::size_t block_size)
+    : engine_(engine), num_threads_(num_threads), block_size_(block_size) {}
+
+void Clusterer::run(std::vector<Point>& puntos, double epsilon, int min_samples) {
+    if (curva_ == Curve::Ninguna) {
+        dispatch(puntos, epsilon, min_samples);
+        return;
+    }
+
+    if (num_threads_ > 0) {
+        omp_set_num_threads(num_threads_);
+    }
+    const std::size_t n = puntos.size();
+    const double inicio = omp_get_wtime();
+    buildSpatialOrder(puntos, curva_, orden_);
+    const std::size_t* orden = orden_.orden.data();
+    ordenados_.resize(n);
+#pragma omp parallel for schedule(static)
+    for (std::size_t k = 0; k < n; ++k) {
+        ordenados_[k] = puntos[orden[k]];
+    }
+    double reorden = omp_get_wtime() - inicio;
+
+    dispatch(ordenados_, epsilon, min_samples);
+
+    const double inicio_vuelta = omp_get_wtime();
+#pragma omp parallel for schedule(static)
+    for (std::size_t k = 0; k < n; ++k) {
+        puntos[orden[k]].label = ordenados_[k].label;
+        puntos[orden[k]].cluster = ordenados_[k].cluster;
+    }
+    reorden += omp_get_wtime() - inicio_vuelta;
+    ws_.fases.preparacion += reorden;
+}
+
+void Clusterer::dispatch(std::vector<Point>& puntos, double epsilon, int min_samples) {
+    switch (engine_) {
+    case Engine::Serial:
+        dbscan_serial(puntos, epsilon, min_samples, ws_);
+        break;
+    case Engine::ParallelFull:
+        dbscan_parallel_full(puntos, epsilon, min_samples, num_threads_, ws_);
+        break;
+    case Engine::ParallelDivided:
+        dbscan_parallel_divided(puntos, epsilon, min_samples, num_threads_, block_size_, ws_);
+        break;
+    case Engine::ParallelTasks:
+        dbscan_parallel_tasks(puntos, epsilon, min_samples, num_threads_, block_size_, ws_);
+        break;
+    case Engine::Grid:
+        dbscan_grid(puntos, epsilon, min_samples, num_threads_, ws_);
+        break;
+    case Engine::KdTree:
+        dbscan_kdtree(puntos, epsilon, min_samples, num_threads_, ws_);
+        break;
+    }
+}
@@ -0,0 +1,155 @@
+#include "dbscan.hpp"
+#include "grid.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using std::size_t;
+
+namespace {
+
+// Union-find concurrente sin candados: cada raíz apunta a sí misma y las uniones
+// siempre enlazan la raíz mayor bajo la menor mediante CAS, así la raíz final de
+// cada componente es el índice original más pequeño sin importar el orden de los hilos.
+class ConcurrentUnionFind {
+public:
+    explicit ConcurrentUnionFind(size_t n) : padre_(new std::atomic<size_t>[n]) {
+#pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            padre_[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    size_t find(size_t x) {
+        while (true) {
+            size_t p = padre_[x].load(std::memory_order_relaxed);
+            if (p == x) {
+                return x;
+            }
+            const size_t abuelo = padre_[p].load(std::memory_order_relaxed);
+            if (abuelo != p) {
+                // Compresión por mitades; si otro hilo ya cambió el padre no pasa nada.
+                padre_[x].compare_exchange_weak(p, abuelo, std::memory_order_relaxed);
+            }
+            x = abuelo;
+        }
+    }
+
+    void unite(size_t a, size_t b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b) {
+                return;
+            }
+            if (a < b) {
+                std::swap(a, b);
+            }
+            size_t esperado = a;
+            if (padre_[a].compare_exchange_strong(esperado, b, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<std::atomic<size_t>[]> padre_;
+};
+
+}
+
+void assignClusters(std::vector<Point>& puntos, double epsilon, int num_threads) {
+    const size_t n = puntos.size();
+    if (n == 0) {
+        return;
+    }
+
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+
+    const double eps2 = epsilon * epsilon;
+    const GridIndex grid = buildGrid(puntos, epsilon);
+    const size_t celdas = grid.cols * grid.rows;
+
+    std::vector<char> es_core(n, 0);
+#pragma omp parallel for schedule(static)
+    for (size_t p = 0; p < n; ++p) {
+        es_core[p] = puntos[grid.orden[p]].label == CORE1;
+    }
+
+    // Une cada par de cores a distancia <= epsilon; cada par se visita una sola vez (q > p).
+    ConcurrentUnionFind uf(n);
+#pragma omp parallel for schedule(dynamic, 16)
+    for (size_t c = 0; c < celdas; ++c) {
+        for (size_t p = grid.inicio[c]; p < grid.inicio[c + 1]; ++p) {
+            if (!es_core[p]) {
+                continue;
+            }
+            const size_t i = grid.orden[p];
+            grid.forEachNeighborRange(c, [&](size_t q_ini, size_t q_fin) {
+                for (size_t q = q_ini > p + 1 ? q_ini : p + 1; q < q_fin; ++q) {
+                    if (!es_core[q]) {
+                        continue;
+                    }
+                    if (squaredNorm(grid.xs[p] - grid.xs[q], grid.ys[p] - grid.ys[q]) <= eps2) {
+                        uf.unite(i, grid.orden[q]);
+                    }
+                }
+            });
+        }
+    }
+
+    // Numeración compacta 0..k-1 en orden del índice original de cada raíz.
+    std::vector<int> id_raiz(n, NOISE);
+    int siguiente = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (puntos[i].label == CORE1 && uf.find(i) == i) {
+            id_raiz[i] = siguiente++;
+        }
+    }
+
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        puntos[i].cluster = puntos[i].label == CORE1 ? id_raiz[uf.find(i)] : NOISE;
+    }
+
+    // Cada punto frontera se une al cluster de su core vecino con menor índice original.
+#pragma omp parallel for schedule(dynamic, 16)
+    for (size_t c = 0; c < celdas; ++c) {
+        for (size_t p = grid.inicio[c]; p < grid.inicio[c + 1]; ++p) {
+            Point& punto = puntos[grid.orden[p]];
+            if (punto.label != CORE2) {
+                continue;
+            }
+            size_t mejor = n;
+            grid.forEachNeighborRange(c, [&](size_t q_ini, size_t q_fin) {
+                for (size_t q = q_ini; q < q_fin; ++q) {
+                    if (!es_core[q] || grid.orden[q] >= mejor) {
+                        continue;
+                    }
+                    if (squaredNorm(grid.xs[p] - grid.xs[q], grid.ys[p] - grid.ys[q]) <= eps2) {
+                        mejor = grid.orden[q];
+                    }
+                }
+            });
+            if (mejor < n) {
+                punto.cluster = puntos[mejor].cluster;
+            }
+        }
+    }
+}
+
+std::vector<Point> dbscan_clusters(const std::string& ruta,
+                                   double epsilon,
+                                   int min_samples,
+                                   int num_threads) {
+    std::vector<Point> puntos = dbscan_grid(ruta, epsilon, min_samples, num_threads);
+    assignClusters(puntos, epsilon, num_threads);
+    return puntos;
+}
@@ -0,0 +1,464 @@
+#ifdef DBSCAN_MPI
+
+#include "distributed.hpp"
+#include "io.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using std::size_t;
+
+namespace {
+
+// Punto en tránsito entre rangos con su posición en la entrada.
+struct PuntoGlobal {
+    double x;
+    double y;
+    std::int64_t indice;
+};
+
+struct EtiquetaGlobal {
+    std::int64_t indice;
+    std::int32_t label;
+    std::int32_t cluster;
+};
+
+template <typename T>
+MPI_Datatype bytesType() {
+    MPI_Datatype tipo;
+    MPI_Type_contiguous(static_cast<int>(sizeof(T)), MPI_BYTE, &tipo);
+    MPI_Type_commit(&tipo);
+    return tipo;
+}
+
+int toCount(size_t valor, MPI_Comm comm) {
+    if (valor > static_cast<size_t>(INT_MAX)) {
+        std::cerr << "Error: más de INT_MAX elementos en un intercambio; usa más rangos" << std::endl;
+        MPI_Abort(comm, 1);
+    }
+    return static_cast<int>(valor);
+}
+
+// Alltoallv de salida[q] hacia el rango q. Devuelve lo recibido concatenado por rango
+// de origen y, si se pide, cuántos elementos llegaron de cada uno.
+template <typename T>
+std::vector<T> exchange(const std::vector<std::vector<T>>& salida,
+                        MPI_Datatype tipo,
+                        MPI_Comm comm,
+                        std::vector<int>* por_rango = nullptr) {
+    const int rangos = static_cast<int>(salida.size());
+    std::vector<int> envio(rangos), recibo(rangos), desp_envio(rangos, 0), desp_recibo(rangos, 0);
+    size_t total_envio = 0;
+    for (int q = 0; q < rangos; ++q) {
+        envio[q] = toCount(salida[q].size(), comm);
+        desp_envio[q] = toCount(total_envio, comm);
+        total_envio += salida[q].size();
+    }
+    MPI_Alltoall(envio.data(), 1, MPI_INT, recibo.data(), 1, MPI_INT, comm);
+    size_t total_recibo = 0;
+    for (int q = 0; q < rangos; ++q) {
+        desp_recibo[q] = toCount(total_recibo, comm);
+        total_recibo += static_cast<size_t>(recibo[q]);
+    }
+    toCount(total_recibo, comm);
+
+    std::vector<T> plano;
+    plano.reserve(total_envio);
+    for (const auto& parte : salida) {
+        plano.insert(plano.end(), parte.begin(), parte.end());
+    }
+    std::vector<T> llegada(total_recibo);
+    MPI_Alltoallv(plano.data(), envio.data(), desp_envio.data(), tipo,
+                  llegada.data(), recibo.data(), desp_recibo.data(), tipo, comm);
+    if (por_rango != nullptr) {
+        *por_rango = std::move(recibo);
+    }
+    return llegada;
+}
+
+// Trozo de la entrada que lee este rango. En CSV el rango toma los bytes
+// [r·size/p, (r+1)·size/p) ajustados a inicio de línea; su primer índice global es la
+// suma de las líneas válidas de los rangos anteriores.
+std::vector<Point> readShare(const std::string& ruta, MPI_Comm comm, std::int64_t& primero, std::int64_t& total) {
+    int rango = 0;
+    int rangos = 1;
+    MPI_Comm_rank(comm, &rango);
+    MPI_Comm_size(comm, &rangos);
+    const auto r = static_cast<std::uint64_t>(rango);
+    const auto p = static_cast<std::uint64_t>(rangos);
+
+    std::vector<Point> puntos;
+    if (isBinaryPath(ruta)) {
+        const MappedPoints mapa(ruta);
+        if (mapa.ok() && mapa.dims() >= 2) {
+            const std::uint64_t n = mapa.size();
+            const size_t desde = static_cast<size_t>(n * r / p);
+            const size_t hasta = static_cast<size_t>(n * (r + 1) / p);
+            const double* xs = mapa.column(0);
+            const double* ys = mapa.column(1);
+            puntos.resize(hasta - desde);
+#pragma omp parallel for schedule(static)
+            for (size_t i = desde; i < hasta; ++i) {
+                puntos[i - desde].x = xs[i];
+                puntos[i - desde].y = ys[i];
+            }
+        }
+    } else {
+        const MappedFile mapa(ruta);
+        if (mapa.ok()) {
+            const char* data = mapa.data();
+            const std::uint64_t size = mapa.size();
+            auto inicioLinea = [&](std::uint64_t pos) {
+                while (pos > 0 && pos < size && data[pos - 1] != '\n') {
+                    ++pos;
+                }
+                return std::min(pos, size);
+            };
+            const std::uint64_t desde = inicioLinea(size * r / p);
+            const std::uint64_t hasta = rango + 1 == rangos ? size : inicioLinea(size * (r + 1) / p);
+            if (hasta > desde) {
+                puntos = parsePointsCSV(data + desde, static_cast<size_t>(hasta - desde));
+            }
+        }
+    }
+
+    std::int64_t propios = static_cast<std::int64_t>(puntos.size());
+    primero = 0;
+    MPI_Exscan(&propios, &primero, 1, MPI_INT64_T, MPI_SUM, comm);
+    if (rango == 0) {
+        primero = 0;
+    }
+    MPI_Allreduce(&propios, &total, 1, MPI_INT64_T, MPI_SUM, comm);
+    return puntos;
+}
+
+// rangos - 1 cortes en x en los cuantiles de una muestra de ~1024 puntos por rango,
+// tomada con el mismo paso en todos para que cada rango pese según sus puntos.
+std::vector<double> chooseCuts(const std::vector<Point>& puntos, std::int64_t total, MPI_Comm comm) {
+    int rangos = 1;
+    MPI_Comm_size(comm, &rangos);
+    constexpr std::int64_t MUESTRA_POR_RANGO = 1024;
+    const size_t paso = static_cast<size_t>(std::max<std::int64_t>(1, total / (MUESTRA_POR_RANGO * rangos)));
+    std::vector<double> muestra;
+    for (size_t i = 0; i < puntos.size(); i += paso) {
+        muestra.push_back(puntos[i].x);
+    }
+
+    const int cuantos = static_cast<int>(muestra.size());
+    std::vector<int> cuantos_por_rango(rangos), desp(rangos, 0);
+    MPI_Allgather(&cuantos, 1, MPI_INT, cuantos_por_rango.data(), 1, MPI_INT, comm);
+    for (int q = 1; q < rangos; ++q) {
+        desp[q] = desp[q - 1] + cuantos_por_rango[q - 1];
+    }
+    std::vector<double> todas(static_cast<size_t>(desp[rangos - 1] + cuantos_por_rango[rangos - 1]));
+    MPI_Allgatherv(muestra.data(), cuantos, MPI_DOUBLE, todas.data(), cuantos_por_rango.data(), desp.data(),
+                   MPI_DOUBLE, comm);
+    std::sort(todas.begin(), todas.end());
+
+    std::vector<double> cortes(static_cast<size_t>(rangos - 1), std::numeric_limits<double>::infinity());
+    if (todas.empty()) {
+        return cortes;
+    }
+    for (int k = 1; k < rangos; ++k) {
+        cortes[static_cast<size_t>(k - 1)] = todas[todas.size() * static_cast<size_t>(k) / static_cast<size_t>(rangos)];
+    }
+    return cortes;
+}
+
+}
+
+DistributedResult dbscan_distributed(const std::string& ruta,
+                                     double epsilon,
+                                     int min_samples,
+                                     Engine engine,
+                                     int num_threads,
+                                     size_t block_size,
+                                     MPI_Comm comm) {
+    int rango = 0;
+    int rangos = 1;
+    MPI_Comm_rank(comm, &rango);
+    MPI_Comm_size(comm, &rangos);
+    const MPI_Datatype tipo_punto = bytesType<PuntoGlobal>();
+    const MPI_Datatype tipo_etiqueta = bytesType<EtiquetaGlobal>();
+
+    DistributedResult resultado;
+    double marca = MPI_Wtime();
+    resultado.puntos = readShare(ruta, comm, resultado.primero, resultado.total);
+    std::vector<Point>& leidos = resultado.puntos;
+    resultado.lectura = MPI_Wtime() - marca;
+    marca = MPI_Wtime();
+
+    // Franja del rango q: [cortes[q - 1], cortes[q]).
+    const std::vector<double> cortes = chooseCuts(leidos, resultado.total, comm);
+    auto dueno = [&](double x) { return static_cast<int>(std::upper_bound(cortes.begin(), cortes.end(), x) - cortes.begin()); };
+    resultado.corte_min = rango > 0 ? cortes[static_cast<size_t>(rango - 1)] : -std::numeric_limits<double>::infinity();
+    resultado.corte_max = rango + 1 < rangos ? cortes[static_cast<size_t>(rango)] : std::numeric_limits<double>::infinity();
+
+    std::vector<std::vector<PuntoGlobal>> salida(static_cast<size_t>(rangos));
+    for (size_t i = 0; i < leidos.size(); ++i) {
+        salida[static_cast<size_t>(dueno(leidos[i].x))].push_back(
+            {leidos[i].x, leidos[i].y, resultado.primero + static_cast<std::int64_t>(i)});
+    }
+    const std::vector<PuntoGlobal> propios = exchange(salida, tipo_punto, comm);
+    salida.assign(static_cast<size_t>(rangos), {});
+
+    // El margen cubre el redondeo de dx·dx frente a eps²: un vecino a distancia
+    // exactamente epsilon no debe quedar fuera del halo.
+    const double ancho = epsilon * (1.0 + 1e-9);
+    std::vector<std::vector<size_t>> enviados(static_cast<size_t>(rangos));
+    for (size_t k = 0; k < propios.size(); ++k) {
+        const int q0 = dueno(propios[k].x - ancho);
+        const int q1 = dueno(propios[k].x + ancho);
+        for (int q = q0; q <= q1; ++q) {
+            if (q != rango) {
+                salida[static_cast<size_t>(q)].push_back(propios[k]);
+                enviados[static_cast<size_t>(q)].push_back(k);
+            }
+        }
+    }
+    std::vector<int> halo_por_rango;
+    const std::vector<PuntoGlobal> halo = exchange(salida, tipo_punto, comm, &halo_por_rango);
+    salida.clear();
+    resultado.propios = propios.size();
+    resultado.halo = halo.size();
+    resultado.reparto = MPI_Wtime() - marca;
+    marca = MPI_Wtime();
+
+    std::vector<Point> local(propios.size() + halo.size());
+    for (size_t k = 0; k < propios.size(); ++k) {
+        local[k].x = propios[k].x;
+        local[k].y = propios[k].y;
+    }
+    for (size_t k = 0; k < halo.size(); ++k) {
+        local[propios.size() + k].x = halo[k].x;
+        local[propios.size() + k].y = halo[k].y;
+    }
+    Clusterer clusterer(engine, num_threads, block_size);
+    clusterer.run(local, epsilon, min_samples);
+    resultado.local = MPI_Wtime() - marca;
+    marca = MPI_Wtime();
+
+    // Estado core real de cada punto de halo, en el mismo orden en que se envió.
+    std::vector<std::vector<char>> cores_salida(static_cast<size_t>(rangos));
+    for (int q = 0; q < rangos; ++q) {
+        for (size_t k : enviados[static_cast<size_t>(q)]) {
+            cores_salida[static_cast<size_t>(q)].push_back(local[k].label == CORE1 ? 1 : 0);
+        }
+    }
+    const std::vector<char> halo_es_core = exchange(cores_salida, MPI_CHAR, comm);
+
+    std::vector<Point> faltantes;
+    for (size_t k = 0; k < halo.size(); ++k) {
+        if (halo_es_core[k] != 0 && local[propios.size() + k].label != CORE1) {
+            faltantes.push_back(local[propios.size() + k]);
+        }
+    }
+    resultado.promovidos = faltantes.size();
+    if (!faltantes.empty()) {
+        PointsSoA cores_halo;
+        cores_halo.assign(faltantes);
+        const double eps2 = epsilon * epsilon;
+        const double borde_min = resultado.corte_min + ancho;
+        const double borde_max = resultado.corte_max - ancho;
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (size_t k = 0; k < propios.size(); ++k) {
+            Point& p = local[k];
+            if (p.label == NOISE && (p.x < borde_min || p.x >= borde_max) &&
+                anyWithin(p.x, p.y, cores_halo.x.data(), cores_halo.y.data(), cores_halo.size(), eps2)) {
+                p.label = CORE2;
+            }
+        }
+    }
+
+    // Clusters. assignClusters sobre propios + halo ordenados por índice global, con el
+    // halo que no es core como ruido, une los mismos cores y elige para cada frontera
+    // propia el mismo core que la corrida serial: todos sus vecinos están aquí. Falta
+    // unir los componentes que siguen en otras franjas: cada componente se nombra por
+    // el menor índice global de sus cores y ese mínimo cruza por los cores de halo, de
+    // ida al dueño y de vuelta, hasta que ningún rango cambia.
+    const size_t m = local.size();
+    auto indiceGlobal = [&](size_t k) {
+        return k < propios.size() ? propios[k].indice : halo[k - propios.size()].indice;
+    };
+    std::vector<size_t> orden(m);
+    std::iota(orden.begin(), orden.end(), size_t{0});
+    std::sort(orden.begin(), orden.end(), [&](size_t a, size_t b) { return indiceGlobal(a) < indiceGlobal(b); });
+    std::vector<Point> ordenados(m);
+    for (size_t r = 0; r < m; ++r) {
+        const size_t k = orden[r];
+        ordenados[r] = local[k];
+        if (k >= propios.size()) {
+            ordenados[r].label = halo_es_core[k - propios.size()] != 0 ? CORE1 : NOISE;
+        }
+    }
+    assignClusters(ordenados, epsilon, num_threads);
+
+    // componente[k]: cluster local del punto k; nombre[c]: menor índice global conocido
+    // entre los cores de c. La numeración de assignClusters sigue la raíz de menor
+    // índice, así que el primer core de c en orden global es su raíz.
+    std::vector<int> componente(m, NOISE);
+    std::vector<std::int64_t> nombre;
+    for (size_t r = 0; r < m; ++r) {
+        const int c = ordenados[r].cluster;
+        componente[orden[r]] = c;
+        if (ordenados[r].label == CORE1 && static_cast<size_t>(c) == nombre.size()) {
+            nombre.push_back(indiceGlobal(orden[r]));
+        }
+    }
+    ordenados.clear();
+    ordenados.shrink_to_fit();
+
+    constexpr std::int64_t SIN_NOMBRE = std::numeric_limits<std::int64_t>::max();
+    auto esCorePropio = [&](size_t k) { return local[k].label == CORE1 && componente[k] != NOISE; };
+    std::vector<std::vector<std::int64_t>> nombres_salida(static_cast<size_t>(rangos));
+    int cambio = 1;
+    while (cambio != 0) {
+        cambio = 0;
+        // Halo -> dueño, en el orden en que llegó el halo de cada rango.
+        size_t k = propios.size();
+        for (int q = 0; q < rangos; ++q) {
+            auto& parte = nombres_salida[static_cast<size_t>(q)];
+            parte.clear();
+            for (int t = 0; t < halo_por_rango[static_cast<size_t>(q)]; ++t, ++k) {
+                parte.push_back(componente[k] != NOISE ? nombre[static_cast<size_t>(componente[k])] : SIN_NOMBRE);
+            }
+        }
+        std::vector<std::int64_t> recibidos = exchange(nombres_salida, MPI_INT64_T, comm);
+        size_t pos = 0;
+        for (int q = 0; q < rangos; ++q) {
+            for (size_t j : enviados[static_cast<size_t>(q)]) {
+                const std::int64_t valor = recibidos[pos++];
+                if (esCorePropio(j) && valor < nombre[static_cast<size_t>(componente[j])]) {
+                    nombre[static_cast<size_t>(componente[j])] = valor;
+                    cambio = 1;
+                }
+            }
+        }
+
+        // Dueño -> halo, con los nombres ya actualizados.
+        for (int q = 0; q < rangos; ++q) {
+            auto& parte = nombres_salida[static_cast<size_t>(q)];
+            parte.clear();
+            for (size_t j : enviados[static_cast<size_t>(q)]) {
+                parte.push_back(esCorePropio(j) ? nombre[static_cast<size_t>(componente[j])] : SIN_NOMBRE);
+            }
+        }
+        recibidos = exchange(nombres_salida, MPI_INT64_T, comm);
+        for (size_t h = 0; h < halo.size(); ++h) {
+            const int c = componente[propios.size() + h];
+            if (c != NOISE && recibidos[h] < nombre[static_cast<size_t>(c)]) {
+                nombre[static_cast<size_t>(c)] = recibidos[h];
+                cambio = 1;
+            }
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &cambio, 1, MPI_INT, MPI_LOR, comm);
+    }
+
+    // Numeración compacta 0..k-1 en orden del nombre, como assignClusters: cada rango
+    // aporta los nombres de los clusters con algún core propio.
+    std::vector<std::int64_t> raices;
+    for (size_t j = 0; j < propios.size(); ++j) {
+        if (esCorePropio(j)) {
+            raices.push_back(nombre[static_cast<size_t>(componente[j])]);
+        }
+    }
+    std::sort(raices.begin(), raices.end());
+    raices.erase(std::unique(raices.begin(), raices.end()), raices.end());
+    const int cuantas = toCount(raices.size(), comm);
+    std::vector<int> cuantas_por_rango(static_cast<size_t>(rangos)), desp(static_cast<size_t>(rangos), 0);
+    MPI_Allgather(&cuantas, 1, MPI_INT, cuantas_por_rango.data(), 1, MPI_INT, comm);
+    size_t total_raices = 0;
+    for (int q = 0; q < rangos; ++q) {
+        desp[static_cast<size_t>(q)] = toCount(total_raices, comm);
+        total_raices += static_cast<size_t>(cuantas_por_rango[static_cast<size_t>(q)]);
+    }
+    std::vector<std::int64_t> todas(total_raices);
+    MPI_Allgatherv(raices.data(), cuantas, MPI_INT64_T, todas.data(), cuantas_por_rango.data(), desp.data(),
+                   MPI_INT64_T, comm);
+    std::sort(todas.begin(), todas.end());
+    todas.erase(std::unique(todas.begin(), todas.end()), todas.end());
+    auto clusterGlobal = [&](size_t j) {
+        if (componente[j] == NOISE) {
+            return NOISE;
+        }
+        const std::int64_t raiz = nombre[static_cast<size_t>(componente[j])];
+        return static_cast<int>(std::lower_bound(todas.begin(), todas.end(), raiz) - todas.begin());
+    };
+
+    // Cada etiqueta y cluster vuelve al rango que leyó el punto.
+    std::vector<std::int64_t> primeros(static_cast<size_t>(rangos));
+    MPI_Allgather(&resultado.primero, 1, MPI_INT64_T, primeros.data(), 1, MPI_INT64_T, comm);
+    std::vector<std::vector<EtiquetaGlobal>> vuelta(static_cast<size_t>(rangos));
+    for (size_t j = 0; j < propios.size(); ++j) {
+        const auto lector = std::upper_bound(primeros.begin(), primeros.end(), propios[j].indice) - primeros.begin() - 1;
+        vuelta[static_cast<size_t>(lector)].push_back({propios[j].indice, local[j].label, clusterGlobal(j)});
+    }
+    const std::vector<EtiquetaGlobal> etiquetas = exchange(vuelta, tipo_etiqueta, comm);
+    resetLabels(leidos);
+    for (const EtiquetaGlobal& e : etiquetas) {
+        Point& p = leidos[static_cast<size_t>(e.indice - resultado.primero)];
+        p.label = e.label;
+        p.cluster = e.cluster;
+    }
+    resultado.reconciliacion = MPI_Wtime() - marca;
+
+    MPI_Datatype tipos[] = {tipo_punto, tipo_etiqueta};
+    for (MPI_Datatype& t : tipos) {
+        MPI_Type_free(&t);
+    }
+    return resultado;
+}
+
+bool writeDistributedResults(const DistributedResult& resultado, const std::string& archivo, MPI_Comm comm) {
+    int rango = 0;
+    MPI_Comm_rank(comm, &rango);
+    const std::vector<Point>& puntos = resultado.puntos;
+    const size_t n = puntos.size();
+
+    double minimos[2] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+    double maximos[2] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+    std::vector<double> xs(n), ys(n);
+    std::vector<std::int32_t> labels(n), clusters(n);
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = puntos[i].x;
+        ys[i] = puntos[i].y;
+        labels[i] = puntos[i].label;
+        clusters[i] = puntos[i].cluster;
+        minimos[0] = std::min(minimos[0], xs[i]);
+        minimos[1] = std::min(minimos[1], ys[i]);
+        maximos[0] = std::max(maximos[0], xs[i]);
+        maximos[1] = std::max(maximos[1], ys[i]);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, minimos, 2, MPI_DOUBLE, MPI_MIN, comm);
+    MPI_Allreduce(MPI_IN_PLACE, maximos, 2, MPI_DOUBLE, MPI_MAX, comm);
+
+    // El rango 0 crea y dimensiona el archivo antes de que los demás lo abran.
+    const auto total = static_cast<std::uint64_t>(resultado.total);
+    const auto primero = static_cast<std::uint64_t>(resultado.primero);
+    int ok = 1;
+    if (rango == 0) {
+        BinaryPointWriter escritor(archivo, total, true, true);
+        ok = escritor.ok() && escritor.write(primero, xs.data(), ys.data(), n) &&
+             escritor.writeLabels(primero, labels.data(), clusters.data(), n);
+        MPI_Barrier(comm);
+        MPI_Barrier(comm);
+        ok = escritor.close(minimos, maximos) && ok;
+    } else {
+        MPI_Barrier(comm);
+        BinaryPointWriter escritor(archivo, total, true, false);
+        ok = escritor.ok() && escritor.write(primero, xs.data(), ys.data(), n) &&
+             escritor.writeLabels(primero, labels.data(), clusters.data(), n);
+        MPI_Barrier(comm);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND, comm);
+    return ok != 0;
+}
+
+#endif
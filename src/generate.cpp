@@ -0,0 +1,242 @@
+#include "generate.hpp"
+#include "io.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+using std::size_t;
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Puntos por trozo al escribir archivos: acota la memoria a unos 100 MB.
+constexpr size_t TROZO_GENERACION = size_t{1} << 22;
+
+// Fracción de ruido uniforme de la distribución noise.
+constexpr double FRACCION_RUIDO = 0.5;
+
+// Mezcla de SplitMix64: a partir de (seed, contador) da 64 bits independientes.
+std::uint64_t mix(std::uint64_t seed, std::uint64_t contador) {
+    std::uint64_t z = seed + (contador + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniforme en (0, 1): 53 bits de mantisa, nunca 0 para que el log de Box-Muller exista.
+double uniform(std::uint64_t seed, std::uint64_t contador) {
+    return (static_cast<double>(mix(seed, contador) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// Cada punto usa los contadores [8 i, 8 i + 8) de su propia secuencia.
+struct Sorteo {
+    std::uint64_t seed;
+    std::uint64_t base;
+    std::uint64_t usados = 0;
+
+    double next() { return uniform(seed, base + usados++); }
+    std::uint64_t bits() { return mix(seed, base + usados++); }
+    void gaussian(double& a, double& b) {
+        const double r = std::sqrt(-2.0 * std::log(next()));
+        const double t = 2.0 * PI * next();
+        a = r * std::cos(t);
+        b = r * std::sin(t);
+    }
+};
+
+// Centros y anchos se derivan de una secuencia aparte (contadores altos) para que no
+// dependan del número de puntos.
+struct Centro {
+    double x, y, desviacion, peso_acumulado;
+};
+
+std::vector<Centro> makeCenters(const GeneratorOptions& opciones) {
+    const int k = std::max(1, opciones.centros);
+    const std::uint64_t semilla = mix(opciones.seed, ~std::uint64_t{0});
+    std::vector<Centro> centros(static_cast<size_t>(k));
+    double total = 0.0;
+    for (int c = 0; c < k; ++c) {
+        Centro& centro = centros[static_cast<size_t>(c)];
+        centro.x = uniform(semilla, 4 * static_cast<std::uint64_t>(c));
+        centro.y = uniform(semilla, 4 * static_cast<std::uint64_t>(c) + 1);
+        double peso = 1.0;
+        centro.desviacion = opciones.desviacion;
+        if (opciones.dist == Distribution::Skewed) {
+            // Pesos geométricos y anchos entre desviacion/8 y desviacion: el primer
+            // centro es el más pesado y el más angosto.
+            peso = std::pow(0.25, c);
+            centro.desviacion = opciones.desviacion * (0.125 + 0.875 * static_cast<double>(c) / std::max(1, k - 1));
+        }
+        total += peso;
+        centro.peso_acumulado = total;
+    }
+    for (Centro& centro : centros) {
+        centro.peso_acumulado /= total;
+    }
+    return centros;
+}
+
+Point pointFrom(const GeneratorOptions& opciones, const std::vector<Centro>& centros, size_t i) {
+    Sorteo sorteo{opciones.seed, 8 * static_cast<std::uint64_t>(i)};
+    Point p;
+    if (opciones.dist == Distribution::Uniform ||
+        (opciones.dist == Distribution::Noise && sorteo.next() < FRACCION_RUIDO)) {
+        p.x = sorteo.next();
+        p.y = sorteo.next();
+        return p;
+    }
+
+    size_t c = 0;
+    if (opciones.dist == Distribution::Skewed) {
+        const double u = sorteo.next();
+        while (c + 1 < centros.size() && centros[c].peso_acumulado < u) {
+            ++c;
+        }
+    } else {
+        c = static_cast<size_t>(sorteo.bits() % centros.size());
+    }
+    double gx, gy;
+    sorteo.gaussian(gx, gy);
+    p.x = centros[c].x + centros[c].desviacion * gx;
+    p.y = centros[c].y + centros[c].desviacion * gy;
+    return p;
+}
+
+char* formatCoordinate(char* p, char* fin, double valor) {
+    return std::to_chars(p, fin, valor, std::chars_format::fixed, 6).ptr;
+}
+
+}
+
+const char* distributionName(Distribution dist) {
+    switch (dist) {
+    case Distribution::Uniform:
+        return "uniform";
+    case Distribution::Blobs:
+        return "blobs";
+    case Distribution::Skewed:
+        return "skewed";
+    case Distribution::Noise:
+        return "noise";
+    }
+    return "desconocida";
+}
+
+bool parseDistribution(const std::string& nombre, Distribution& dist) {
+    for (Distribution candidata : {Distribution::Uniform, Distribution::Blobs, Distribution::Skewed, Distribution::Noise}) {
+        if (nombre == distributionName(candidata)) {
+            dist = candidata;
+            return true;
+        }
+    }
+    return false;
+}
+
+Point generatePoint(const GeneratorOptions& opciones, size_t i) {
+    return pointFrom(opciones, makeCenters(opciones), i);
+}
+
+std::vector<Point> generatePoints(const GeneratorOptions& opciones) {
+    const std::vector<Centro> centros = makeCenters(opciones);
+    std::vector<Point> puntos(opciones.count);
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < opciones.count; ++i) {
+        puntos[i] = pointFrom(opciones, centros, i);
+    }
+    return puntos;
+}
+
+bool generateFile(const GeneratorOptions& opciones, const std::string& archivo) {
+    const std::vector<Centro> centros = makeCenters(opciones);
+    const size_t n = opciones.count;
+    const bool binario = isBinaryPath(archivo);
+
+    std::optional<BinaryPointWriter> bin;
+    std::FILE* csv = nullptr;
+    if (binario) {
+        bin.emplace(archivo, n);
+    } else {
+        csv = std::fopen(archivo.c_str(), "wb");
+    }
+    if (binario ? !bin->ok() : csv == nullptr) {
+        std::cerr << "Error: no se pudo escribir " << archivo << std::endl;
+        return false;
+    }
+
+    double minimos[2] = {0.0, 0.0};
+    double maximos[2] = {0.0, 0.0};
+    std::vector<double> xs, ys;
+    const size_t hilos = static_cast<size_t>(omp_get_max_threads());
+    std::vector<std::vector<char>> textos(hilos);
+    bool ok = true;
+
+    for (size_t inicio = 0; inicio < n && ok; inicio += TROZO_GENERACION) {
+        const size_t cuantos = std::min(TROZO_GENERACION, n - inicio);
+        xs.resize(cuantos);
+        ys.resize(cuantos);
+        double min_x = 1e300, min_y = 1e300, max_x = -1e300, max_y = -1e300;
+#pragma omp parallel for schedule(static) reduction(min : min_x, min_y) reduction(max : max_x, max_y)
+        for (size_t k = 0; k < cuantos; ++k) {
+            const Point p = pointFrom(opciones, centros, inicio + k);
+            xs[k] = p.x;
+            ys[k] = p.y;
+            min_x = std::min(min_x, p.x);
+            max_x = std::max(max_x, p.x);
+            min_y = std::min(min_y, p.y);
+            max_y = std::max(max_y, p.y);
+        }
+        if (inicio == 0) {
+            minimos[0] = min_x, minimos[1] = min_y, maximos[0] = max_x, maximos[1] = max_y;
+        } else {
+            minimos[0] = std::min(minimos[0], min_x), minimos[1] = std::min(minimos[1], min_y);
+            maximos[0] = std::max(maximos[0], max_x), maximos[1] = std::max(maximos[1], max_y);
+        }
+
+        if (binario) {
+            ok = bin->write(inicio, xs.data(), ys.data(), cuantos);
+            continue;
+        }
+
+        // Cada hilo formatea un rango contiguo; los textos se escriben en orden.
+#pragma omp parallel num_threads(static_cast<int>(hilos))
+        {
+            const size_t t = static_cast<size_t>(omp_get_thread_num());
+            const size_t equipo = static_cast<size_t>(omp_get_num_threads());
+            const size_t desde = cuantos * t / equipo;
+            const size_t hasta = cuantos * (t + 1) / equipo;
+            std::vector<char>& texto = textos[t];
+            // Holgura de 25 caracteres por coordenada, incluida la parte entera y el signo.
+            texto.resize((hasta - desde) * 50);
+            char* p = texto.data();
+            char* const fin = texto.data() + texto.size();
+            for (size_t k = desde; k < hasta; ++k) {
+                p = formatCoordinate(p, fin, xs[k]);
+                *p++ = ',';
+                p = formatCoordinate(p, fin, ys[k]);
+                *p++ = '\n';
+            }
+            texto.resize(static_cast<size_t>(p - texto.data()));
+        }
+        for (const std::vector<char>& texto : textos) {
+            if (!texto.empty() && std::fwrite(texto.data(), 1, texto.size(), csv) != texto.size()) {
+                ok = false;
+            }
+        }
+        for (std::vector<char>& texto : textos) {
+            texto.clear();
+        }
+    }
+
+    if (binario) {
+        return bin->close(minimos, maximos) && ok;
+    }
+    return std::fclose(csv) == 0 && ok;
+}
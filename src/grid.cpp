@@ -0,0 +1,192 @@
+#include "dbscan.hpp"
+#include "clusterer.hpp"
+#include "grid.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using std::size_t;
+
+std::size_t GridIndex::cellOf(double x, double y) const {
+    double cx = std::floor((x - min_x) / cell);
+    double cy = std::floor((y - min_y) / cell);
+    if (!(cx >= 0.0)) {
+        cx = 0.0;
+    }
+    if (!(cy >= 0.0)) {
+        cy = 0.0;
+    }
+    const size_t col = std::min(cols - 1, static_cast<size_t>(cx));
+    const size_t row = std::min(rows - 1, static_cast<size_t>(cy));
+    return row * cols + col;
+}
+
+void buildGrid(const std::vector<Point>& puntos, double epsilon, GridIndex& grid) {
+    const size_t n = puntos.size();
+    if (n == 0) {
+        grid.cols = grid.rows = 1;
+        grid.cell = 1.0;
+        grid.inicio.assign(2, 0);
+        grid.orden.clear();
+        grid.celda.clear();
+        grid.xs.clear();
+        grid.ys.clear();
+        return;
+    }
+
+    double min_x = puntos[0].x, max_x = puntos[0].x;
+    double min_y = puntos[0].y, max_y = puntos[0].y;
+    for (const auto& p : puntos) {
+        min_x = std::min(min_x, p.x);
+        max_x = std::max(max_x, p.x);
+        min_y = std::min(min_y, p.y);
+        max_y = std::max(max_y, p.y);
+    }
+
+    // El margen relativo evita que el redondeo en floor() separe dos puntos a
+    // distancia exactamente epsilon por más de una celda.
+    double cell = epsilon > 0.0 ? epsilon * (1.0 + 1e-9) : 0.0;
+    const double extension = std::max(max_x - min_x, max_y - min_y);
+    const double lado_max = std::sqrt(static_cast<double>(std::max<size_t>(4 * n, 1024)));
+    if (cell <= 0.0 || extension / cell > lado_max) {
+        cell = std::max(cell, extension / lado_max);
+    }
+    if (!(cell > 0.0)) {
+        cell = 1.0;
+    }
+
+    grid.min_x = min_x;
+    grid.min_y = min_y;
+    grid.cell = cell;
+    grid.cols = static_cast<size_t>((max_x - min_x) / cell) + 1;
+    grid.rows = static_cast<size_t>((max_y - min_y) / cell) + 1;
+
+    const size_t celdas = grid.cols * grid.rows;
+    std::vector<size_t>& celda = grid.celda;
+    celda.resize(n);
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        celda[i] = grid.cellOf(puntos[i].x, puntos[i].y);
+    }
+
+    // Counting sort estable sin buffer auxiliar: inicio[c] termina como el fin de la
+    // celda c y el recorrido de atrás hacia adelante lo decrementa hasta su inicio.
+    grid.inicio.assign(celdas + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ++grid.inicio[celda[i]];
+    }
+    for (size_t c = 1; c < celdas; ++c) {
+        grid.inicio[c] += grid.inicio[c - 1];
+    }
+    grid.inicio[celdas] = n;
+
+    grid.orden.resize(n);
+    for (size_t i = n; i-- > 0;) {
+        grid.orden[--grid.inicio[celda[i]]] = i;
+    }
+
+    grid.xs.resize(n);
+    grid.ys.resize(n);
+#pragma omp parallel for schedule(static)
+    for (size_t p = 0; p < n; ++p) {
+        grid.xs[p] = puntos[grid.orden[p]].x;
+        grid.ys[p] = puntos[grid.orden[p]].y;
+    }
+}
+
+GridIndex buildGrid(const std::vector<Point>& puntos, double epsilon) {
+    GridIndex grid;
+    buildGrid(puntos, epsilon, grid);
+    return grid;
+}
+
+void dbscan_grid(std::vector<Point>& puntos,
+                 double epsilon,
+                 int min_samples,
+                 int num_threads,
+                 Workspace& ws) {
+    PhaseClock reloj(ws.perf);
+    ws.fases = PhaseTimes{};
+    resetLabels(puntos);
+    const size_t n = puntos.size();
+    if (n == 0) {
+        return;
+    }
+
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+
+    const double eps2 = epsilon * epsilon;
+    buildGrid(puntos, epsilon, ws.grid);
+    const GridIndex& grid = ws.grid;
+    const size_t celdas = grid.cols * grid.rows;
+
+    // vecinos y es_core están en el orden de celda del índice, no en el original.
+    FirstTouchVector<int>& vecinos = ws.vecinos;
+    firstTouchAssign(vecinos, n, 0);
+    FirstTouchVector<char>& es_core = ws.es_core;
+    firstTouchAssign(es_core, n, char{0});
+    ws.fases.preparacion = reloj.lap(ws.perf.preparacion);
+
+    double pares = 0.0;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+ : pares)
+    for (size_t c = 0; c < celdas; ++c) {
+        for (size_t p = grid.inicio[c]; p < grid.inicio[c + 1]; ++p) {
+            // El rango de la propia celda incluye a p (distancia 0), que no cuenta como vecino.
+            std::size_t cuenta = 0;
+            grid.forEachNeighborRange(c, [&](size_t q_ini, size_t q_fin) {
+                cuenta += countWithin(grid.xs[p], grid.ys[p], &grid.xs[q_ini], &grid.ys[q_ini], q_fin - q_ini, eps2);
+                pares += static_cast<double>(q_fin - q_ini);
+            });
+            vecinos[p] = static_cast<int>(cuenta) - (eps2 >= 0.0 ? 1 : 0);
+        }
+    }
+    ws.fases.conteo = reloj.lap(ws.perf.conteo);
+    ws.fases.pares = pares;
+
+#pragma omp parallel for schedule(static)
+    for (size_t p = 0; p < n; ++p) {
+        if (vecinos[p] >= min_samples) {
+            es_core[p] = 1;
+            puntos[grid.orden[p]].label = CORE1;
+        }
+    }
+    ws.fases.cores = reloj.lap(ws.perf.cores);
+
+#pragma omp parallel for schedule(dynamic, 16)
+    for (size_t c = 0; c < celdas; ++c) {
+        for (size_t p = grid.inicio[c]; p < grid.inicio[c + 1]; ++p) {
+            if (es_core[p]) {
+                continue;
+            }
+            bool frontera = false;
+            grid.forEachNeighborRange(c, [&](size_t q_ini, size_t q_fin) {
+                for (size_t q = q_ini; q < q_fin && !frontera; ++q) {
+                    if (es_core[q] &&
+                        squaredNorm(grid.xs[p] - grid.xs[q], grid.ys[p] - grid.ys[q]) <= eps2) {
+                        frontera = true;
+                    }
+                }
+            });
+            if (frontera) {
+                puntos[grid.orden[p]].label = CORE2;
+            }
+        }
+    }
+    ws.fases.frontera = reloj.lap(ws.perf.frontera);
+}
+
+std::vector<Point> dbscan_grid(const std::string& ruta,
+                               double epsilon,
+                               int min_samples,
+                               int num_threads) {
+    std::vector<Point> puntos = loadPoints(ruta);
+    Workspace ws;
+    dbscan_grid(puntos, epsilon, min_samples, num_threads, ws);
+    return puntos;
+}
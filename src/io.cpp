@@ -0,0 +1,638 @@
+#include "io.hpp"
+#include "dbscan_nd.hpp"
+
+#include <omp.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using std::size_t;
+
+MappedFile::MappedFile(const std::string& archivo) {
+    const int fd = ::open(archivo.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            size_ = 0;
+            return;
+        }
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(p);
+    }
+    ::close(fd);
+    ok_ = true;
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& otro) noexcept
+    : data_(otro.data_), size_(otro.size_), ok_(otro.ok_) {
+    otro.data_ = nullptr;
+    otro.size_ = 0;
+    otro.ok_ = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& otro) noexcept {
+    if (this != &otro) {
+        release();
+        data_ = otro.data_;
+        size_ = otro.size_;
+        ok_ = otro.ok_;
+        otro.data_ = nullptr;
+        otro.size_ = 0;
+        otro.ok_ = false;
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    ok_ = false;
+}
+
+namespace {
+
+inline const char* skipBlanks(const char* p, const char* fin) {
+    while (p < fin && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    return p;
+}
+
+// std::from_chars no acepta un '+' inicial, que el lector original con stringstream
+// sí aceptaba ("+0.5"); se salta antes de convertir.
+template <typename T>
+inline std::from_chars_result parseNumber(const char* p, const char* fin, T& valor) {
+    if (p < fin && *p == '+' && p + 1 < fin && p[1] != '+' && p[1] != '-') {
+        ++p;
+    }
+    return std::from_chars(p, fin, valor);
+}
+
+// Lee "x,y" al inicio de [p, fin). Ignora columnas extra, igual que el lector original.
+inline bool parseLine(const char* p, const char* fin, Point& punto) {
+    p = skipBlanks(p, fin);
+    auto r = parseNumber(p, fin, punto.x);
+    if (r.ec != std::errc()) {
+        return false;
+    }
+    p = skipBlanks(r.ptr, fin);
+    if (p == fin || *p != ',') {
+        return false;
+    }
+    p = skipBlanks(p + 1, fin);
+    r = parseNumber(p, fin, punto.y);
+    return r.ec == std::errc();
+}
+
+inline const char* lineEnd(const char* p, const char* fin) {
+    const void* nl = std::memchr(p, '\n', static_cast<size_t>(fin - p));
+    return nl != nullptr ? static_cast<const char*>(nl) : fin;
+}
+
+}
+
+namespace {
+
+// Texto dividido en trozos que empiezan justo después de un salto de línea, con el
+// número acumulado de líneas antes de cada trozo (lineas[t]) y el total al final.
+struct ChunkedText {
+    std::vector<const char*> cortes;
+    std::vector<size_t> lineas;
+
+    size_t chunks() const { return cortes.size() - 1; }
+    size_t totalLines() const { return lineas.back(); }
+};
+
+ChunkedText splitAndCount(const char* data, size_t size) {
+    // Trozos de al menos 1 MiB para que el costo de repartir no domine en archivos chicos.
+    constexpr size_t trozo_min = size_t{1} << 20;
+    const size_t hilos = static_cast<size_t>(omp_get_max_threads());
+    const size_t num_trozos = std::max<size_t>(1, std::min(hilos * 4, size / trozo_min));
+
+    ChunkedText texto;
+    texto.cortes.resize(num_trozos + 1);
+    texto.cortes[0] = data;
+    texto.cortes[num_trozos] = data + size;
+    for (size_t t = 1; t < num_trozos; ++t) {
+        const char* tentativo = std::max(texto.cortes[t - 1], data + size / num_trozos * t);
+        const char* nl = lineEnd(tentativo, data + size);
+        texto.cortes[t] = nl < data + size ? nl + 1 : data + size;
+    }
+
+    texto.lineas.assign(num_trozos + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t t = 0; t < num_trozos; ++t) {
+        size_t cuenta = 0;
+        for (const char* p = texto.cortes[t]; p < texto.cortes[t + 1];) {
+            p = lineEnd(p, texto.cortes[t + 1]) + 1;
+            ++cuenta;
+        }
+        texto.lineas[t + 1] = cuenta;
+    }
+    for (size_t t = 0; t < num_trozos; ++t) {
+        texto.lineas[t + 1] += texto.lineas[t];
+    }
+    return texto;
+}
+
+// Recorre cada trozo en paralelo; parse(p, fin, fila) escribe la fila destino y
+// devuelve si la línea era válida. Devuelve cuántas filas válidas dejó cada trozo
+// al inicio de su rango [lineas[t], lineas[t + 1]).
+template <typename ParseFn>
+std::vector<size_t> parseChunks(const ChunkedText& texto, ParseFn&& parse) {
+    const size_t num_trozos = texto.chunks();
+    std::vector<size_t> validos(num_trozos, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t t = 0; t < num_trozos; ++t) {
+        size_t destino = texto.lineas[t];
+        for (const char* p = texto.cortes[t]; p < texto.cortes[t + 1];) {
+            const char* fin = lineEnd(p, texto.cortes[t + 1]);
+            if (parse(p, fin, destino)) {
+                ++destino;
+            }
+            p = fin + 1;
+        }
+        validos[t] = destino - texto.lineas[t];
+    }
+    return validos;
+}
+
+// Compacta los huecos que dejaron encabezados o líneas vacías (normalmente ninguno).
+// Las filas son bloques de `ancho` elementos consecutivos en `datos`.
+template <typename V>
+size_t compactRows(V& datos, size_t ancho, const ChunkedText& texto, const std::vector<size_t>& validos) {
+    size_t total = validos[0];
+    for (size_t t = 1; t < validos.size(); ++t) {
+        if (total != texto.lineas[t]) {
+            std::copy(datos.begin() + static_cast<std::ptrdiff_t>(texto.lineas[t] * ancho),
+                      datos.begin() + static_cast<std::ptrdiff_t>((texto.lineas[t] + validos[t]) * ancho),
+                      datos.begin() + static_cast<std::ptrdiff_t>(total * ancho));
+        }
+        total += validos[t];
+    }
+    return total;
+}
+
+// Lee dims valores separados por coma; columnas extra se ignoran.
+template <typename T>
+bool parseFields(const char* p, const char* fin, size_t dims, T* destino) {
+    for (size_t k = 0; k < dims; ++k) {
+        if (k > 0) {
+            p = skipBlanks(p, fin);
+            if (p == fin || *p != ',') {
+                return false;
+            }
+            ++p;
+        }
+        p = skipBlanks(p, fin);
+        const auto r = parseNumber(p, fin, destino[k]);
+        if (r.ec != std::errc()) {
+            return false;
+        }
+        p = r.ptr;
+    }
+    return true;
+}
+
+// Columnas de la primera línea cuyo primer campo es numérico.
+size_t inferColumns(const char* data, size_t size) {
+    const char* const fin_datos = data + size;
+    for (const char* p = data; p < fin_datos;) {
+        const char* fin = lineEnd(p, fin_datos);
+        double valor;
+        const char* inicio = skipBlanks(p, fin);
+        if (parseNumber(inicio, fin, valor).ec == std::errc()) {
+            return static_cast<size_t>(std::count(p, fin, ',')) + 1;
+        }
+        p = fin + 1;
+    }
+    return 0;
+}
+
+}
+
+std::vector<Point> parsePointsCSV(const char* data, size_t size) {
+    if (data == nullptr || size == 0) {
+        return {};
+    }
+
+    // Pasada 1: líneas por trozo para reservar la salida completa una sola vez.
+    const ChunkedText texto = splitAndCount(data, size);
+
+    // Pasada 2: cada trozo escribe sus puntos válidos al inicio de su rango.
+    std::vector<Point> puntos(texto.totalLines());
+    const std::vector<size_t> validos = parseChunks(texto, [&](const char* p, const char* fin, size_t fila) {
+        return parseLine(p, fin, puntos[fila]);
+    });
+
+    puntos.resize(compactRows(puntos, 1, texto, validos));
+    return puntos;
+}
+
+template <typename T>
+bool loadCoordinatesCSV(const std::string& archivo, std::vector<T>& coords, size_t& dims) {
+    const MappedFile mapa(archivo);
+    if (!mapa.ok()) {
+        std::cerr << "Error: no se pudo abrir " << archivo << std::endl;
+        return false;
+    }
+    coords.clear();
+    dims = inferColumns(mapa.data(), mapa.size());
+    if (dims == 0) {
+        return false;
+    }
+
+    const ChunkedText texto = splitAndCount(mapa.data(), mapa.size());
+    coords.resize(texto.totalLines() * dims);
+    const size_t ancho = dims;
+    const std::vector<size_t> validos = parseChunks(texto, [&](const char* p, const char* fin, size_t fila) {
+        return parseFields(p, fin, ancho, coords.data() + fila * ancho);
+    });
+    coords.resize(compactRows(coords, dims, texto, validos) * dims);
+    return !coords.empty();
+}
+
+template bool loadCoordinatesCSV<float>(const std::string&, std::vector<float>&, size_t&);
+template bool loadCoordinatesCSV<double>(const std::string&, std::vector<double>&, size_t&);
+
+namespace {
+
+constexpr std::uint64_t ALINEACION_COLUMNA = 64;
+
+std::uint64_t alignUp(std::uint64_t valor) {
+    return (valor + ALINEACION_COLUMNA - 1) / ALINEACION_COLUMNA * ALINEACION_COLUMNA;
+}
+
+// Escribe una columna obtenida de los puntos por trozos, sin materializarla completa.
+template <typename T, typename F>
+void writeColumn(std::ofstream& out, const std::vector<Point>& puntos, F&& campo) {
+    constexpr size_t trozo = 1 << 16;
+    std::vector<T> buffer;
+    buffer.reserve(std::min(trozo, puntos.size()));
+    for (size_t inicio = 0; inicio < puntos.size(); inicio += trozo) {
+        const size_t fin = std::min(puntos.size(), inicio + trozo);
+        buffer.clear();
+        for (size_t i = inicio; i < fin; ++i) {
+            buffer.push_back(static_cast<T>(campo(puntos[i])));
+        }
+        out.write(reinterpret_cast<const char*>(buffer.data()),
+                  static_cast<std::streamsize>(buffer.size() * sizeof(T)));
+    }
+    const std::uint64_t bytes = puntos.size() * sizeof(T);
+    const std::vector<char> relleno(alignUp(bytes) - bytes, 0);
+    out.write(relleno.data(), static_cast<std::streamsize>(relleno.size()));
+}
+
+}
+
+bool isBinaryPath(const std::string& archivo) {
+    return std::filesystem::path(archivo).extension() == ".bin";
+}
+
+MappedPoints::MappedPoints(const std::string& archivo) : mapa_(archivo) {
+    if (!mapa_.ok() || mapa_.size() < sizeof(BinaryHeader)) {
+        return;
+    }
+    const auto* header = reinterpret_cast<const BinaryHeader*>(mapa_.data());
+    if (std::memcmp(header->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0 ||
+        header->version != BINARY_VERSION || (header->dims == 0 && header->etiquetas == 0)) {
+        return;
+    }
+    header_ = header;
+    const size_t columnas = header->dims + (header->etiquetas != 0 ? 2 : 0);
+    if (columnOffset(columnas) > mapa_.size()) {
+        header_ = nullptr;
+    }
+}
+
+size_t MappedPoints::columnOffset(size_t columna) const {
+    const std::uint64_t n = header_->count;
+    std::uint64_t offset = header_->data_offset;
+    for (size_t c = 0; c < columna; ++c) {
+        offset += alignUp(n * (c < header_->dims ? sizeof(double) : sizeof(std::int32_t)));
+    }
+    return static_cast<size_t>(offset);
+}
+
+const double* MappedPoints::column(size_t d) const {
+    return reinterpret_cast<const double*>(mapa_.data() + columnOffset(d));
+}
+
+const double* MappedPoints::boundsMin() const {
+    return reinterpret_cast<const double*>(mapa_.data() + sizeof(BinaryHeader));
+}
+
+const double* MappedPoints::boundsMax() const {
+    return boundsMin() + header_->dims;
+}
+
+const std::int32_t* MappedPoints::labels() const {
+    return hasLabels() ? reinterpret_cast<const std::int32_t*>(mapa_.data() + columnOffset(header_->dims)) : nullptr;
+}
+
+const std::int32_t* MappedPoints::clusters() const {
+    return hasLabels() ? reinterpret_cast<const std::int32_t*>(mapa_.data() + columnOffset(header_->dims + 1)) : nullptr;
+}
+
+std::vector<Point> loadPointsBinary(const std::string& archivo) {
+    const MappedPoints mapa(archivo);
+    if (!mapa.ok() || mapa.dims() < 2) {
+        std::cerr << "Error: " << archivo << " no es un archivo de puntos binario válido" << std::endl;
+        return {};
+    }
+    const size_t n = mapa.size();
+    const double* xs = mapa.column(0);
+    const double* ys = mapa.column(1);
+    std::vector<Point> puntos(n);
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        puntos[i].x = xs[i];
+        puntos[i].y = ys[i];
+    }
+    return puntos;
+}
+
+bool writePointsBinary(const std::vector<Point>& puntos, const std::string& archivo, bool con_etiquetas) {
+    std::ofstream out(archivo, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: no se pudo escribir " << archivo << std::endl;
+        return false;
+    }
+
+    constexpr std::uint32_t dims = 2;
+    double minimos[dims] = {0.0, 0.0};
+    double maximos[dims] = {0.0, 0.0};
+    if (!puntos.empty()) {
+        minimos[0] = maximos[0] = puntos[0].x;
+        minimos[1] = maximos[1] = puntos[0].y;
+        for (const auto& p : puntos) {
+            minimos[0] = std::min(minimos[0], p.x);
+            maximos[0] = std::max(maximos[0], p.x);
+            minimos[1] = std::min(minimos[1], p.y);
+            maximos[1] = std::max(maximos[1], p.y);
+        }
+    }
+
+    BinaryHeader header{};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.dims = dims;
+    header.count = puntos.size();
+    header.etiquetas = con_etiquetas ? 1 : 0;
+    header.data_offset = alignUp(sizeof(BinaryHeader) + 2 * dims * sizeof(double));
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(minimos), sizeof(minimos));
+    out.write(reinterpret_cast<const char*>(maximos), sizeof(maximos));
+    const std::vector<char> relleno(header.data_offset - sizeof(header) - sizeof(minimos) - sizeof(maximos), 0);
+    out.write(relleno.data(), static_cast<std::streamsize>(relleno.size()));
+
+    writeColumn<double>(out, puntos, [](const Point& p) { return p.x; });
+    writeColumn<double>(out, puntos, [](const Point& p) { return p.y; });
+    if (con_etiquetas) {
+        writeColumn<std::int32_t>(out, puntos, [](const Point& p) { return p.label; });
+        writeColumn<std::int32_t>(out, puntos, [](const Point& p) { return p.cluster; });
+    }
+    return static_cast<bool>(out);
+}
+
+namespace {
+
+bool pwriteAll(int fd, const void* datos, size_t bytes, std::uint64_t offset) {
+    const char* p = static_cast<const char*>(datos);
+    while (bytes > 0) {
+        const ssize_t escritos = ::pwrite(fd, p, bytes, static_cast<off_t>(offset));
+        if (escritos <= 0) {
+            return false;
+        }
+        p += escritos;
+        bytes -= static_cast<size_t>(escritos);
+        offset += static_cast<std::uint64_t>(escritos);
+    }
+    return true;
+}
+
+}
+
+bool writePointsCSV(const std::vector<Point>& puntos, const std::string& archivo, bool con_coordenadas) {
+    const int fd = ::open(archivo.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: no se pudo escribir " << archivo << std::endl;
+        return false;
+    }
+    const char* encabezado = con_coordenadas ? "x,y,label,cluster\n" : "label,cluster\n";
+    std::uint64_t posicion = std::strlen(encabezado);
+    bool ok = pwriteAll(fd, encabezado, posicion, 0);
+
+    // Una fila ocupa a lo más dos doubles (24 caracteres con to_chars) y dos int32.
+    constexpr size_t FILAS_POR_TROZO = size_t{1} << 14;
+    constexpr size_t BYTES_POR_FILA = 2 * 24 + 2 * 11 + 4;
+    const size_t n = puntos.size();
+    const size_t trozos = static_cast<size_t>(omp_get_max_threads());
+    std::vector<std::vector<char>> buffers(trozos);
+    std::vector<size_t> largos(trozos);
+    std::vector<std::uint64_t> offsets(trozos);
+
+    // Por rondas de un trozo por hilo: se formatean en paralelo, los largos dan la
+    // posición de cada trozo en el archivo y se escriben en paralelo con pwrite.
+    for (size_t ronda = 0; ronda < n && ok; ronda += trozos * FILAS_POR_TROZO) {
+#pragma omp parallel for schedule(static, 1)
+        for (size_t k = 0; k < trozos; ++k) {
+            const size_t inicio = std::min(n, ronda + k * FILAS_POR_TROZO);
+            const size_t fin = std::min(n, inicio + FILAS_POR_TROZO);
+            std::vector<char>& buffer = buffers[k];
+            buffer.resize(FILAS_POR_TROZO * BYTES_POR_FILA);
+            char* p = buffer.data();
+            char* const limite = buffer.data() + buffer.size();
+            for (size_t i = inicio; i < fin; ++i) {
+                if (con_coordenadas) {
+                    p = std::to_chars(p, limite, puntos[i].x).ptr;
+                    *p++ = ',';
+                    p = std::to_chars(p, limite, puntos[i].y).ptr;
+                    *p++ = ',';
+                }
+                p = std::to_chars(p, limite, puntos[i].label).ptr;
+                *p++ = ',';
+                p = std::to_chars(p, limite, puntos[i].cluster).ptr;
+                *p++ = '\n';
+            }
+            largos[k] = static_cast<size_t>(p - buffer.data());
+        }
+        for (size_t k = 0; k < trozos; ++k) {
+            offsets[k] = posicion;
+            posicion += largos[k];
+        }
+        bool escrito = true;
+#pragma omp parallel for schedule(static, 1) reduction(&& : escrito)
+        for (size_t k = 0; k < trozos; ++k) {
+            escrito = pwriteAll(fd, buffers[k].data(), largos[k], offsets[k]) && escrito;
+        }
+        ok = escrito;
+    }
+    ok = ::ftruncate(fd, static_cast<off_t>(posicion)) == 0 && ok;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok) {
+        std::cerr << "Error: no se pudo escribir " << archivo << std::endl;
+    }
+    return ok;
+}
+
+bool writeLabelsBinary(const std::vector<Point>& puntos, const std::string& archivo) {
+    std::ofstream out(archivo, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: no se pudo escribir " << archivo << std::endl;
+        return false;
+    }
+    BinaryHeader header{};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.dims = 0;
+    header.count = puntos.size();
+    header.etiquetas = 1;
+    header.data_offset = alignUp(sizeof(BinaryHeader));
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const std::vector<char> relleno(header.data_offset - sizeof(header), 0);
+    out.write(relleno.data(), static_cast<std::streamsize>(relleno.size()));
+    writeColumn<std::int32_t>(out, puntos, [](const Point& p) { return p.label; });
+    writeColumn<std::int32_t>(out, puntos, [](const Point& p) { return p.cluster; });
+    return static_cast<bool>(out);
+}
+
+BinaryPointWriter::BinaryPointWriter(const std::string& archivo, std::uint64_t count, bool con_etiquetas, bool crear) {
+    std::memcpy(header_.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header_.version = BINARY_VERSION;
+    header_.dims = 2;
+    header_.count = count;
+    header_.etiquetas = con_etiquetas ? 1 : 0;
+    header_.data_offset = alignUp(sizeof(BinaryHeader) + 2 * header_.dims * sizeof(double));
+
+    fd_ = ::open(archivo.c_str(), crear ? O_WRONLY | O_CREAT | O_TRUNC : O_WRONLY, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Error: no se pudo escribir " << archivo << std::endl;
+        return;
+    }
+    if (!crear) {
+        return;
+    }
+    std::uint64_t total = header_.data_offset + 2 * alignUp(count * sizeof(double));
+    if (con_etiquetas) {
+        total += 2 * alignUp(count * sizeof(std::int32_t));
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(total)) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+BinaryPointWriter::~BinaryPointWriter() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool BinaryPointWriter::write(std::uint64_t inicio, const double* xs, const double* ys, size_t cuantos) {
+    if (fd_ < 0 || inicio + cuantos > header_.count) {
+        return false;
+    }
+    const std::uint64_t columna_y = header_.data_offset + alignUp(header_.count * sizeof(double));
+    return pwriteAll(fd_, xs, cuantos * sizeof(double), header_.data_offset + inicio * sizeof(double)) &&
+           pwriteAll(fd_, ys, cuantos * sizeof(double), columna_y + inicio * sizeof(double));
+}
+
+std::uint64_t BinaryPointWriter::labelsOffset() const {
+    return header_.data_offset + 2 * alignUp(header_.count * sizeof(double));
+}
+
+bool BinaryPointWriter::writeLabels(std::uint64_t inicio,
+                                    const std::int32_t* labels,
+                                    const std::int32_t* clusters,
+                                    size_t cuantos) {
+    if (fd_ < 0 || header_.etiquetas == 0 || inicio + cuantos > header_.count) {
+        return false;
+    }
+    const std::uint64_t columna_label = labelsOffset();
+    const std::uint64_t columna_cluster = columna_label + alignUp(header_.count * sizeof(std::int32_t));
+    return pwriteAll(fd_, labels, cuantos * sizeof(std::int32_t), columna_label + inicio * sizeof(std::int32_t)) &&
+           pwriteAll(fd_, clusters, cuantos * sizeof(std::int32_t), columna_cluster + inicio * sizeof(std::int32_t));
+}
+
+bool BinaryPointWriter::close(const double minimos[2], const double maximos[2]) {
+    if (fd_ < 0) {
+        return false;
+    }
+    const bool ok = pwriteAll(fd_, &header_, sizeof(header_), 0) &&
+                    pwriteAll(fd_, minimos, 2 * sizeof(double), sizeof(header_)) &&
+                    pwriteAll(fd_, maximos, 2 * sizeof(double), sizeof(header_) + 2 * sizeof(double));
+    const bool cerrado = ::close(fd_) == 0;
+    fd_ = -1;
+    return ok && cerrado;
+}
+
+std::string writeResultsBinary(const std::vector<Point>& puntos,
+                               const std::string& output_dir,
+                               const std::string& etiqueta) {
+    namespace fs = std::filesystem;
+    if (!fs::exists(output_dir)) {
+        fs::create_directories(output_dir);
+    }
+    const std::string archivo =
+        output_dir + "/" + std::to_string(puntos.size()) + "_results_" + etiqueta + ".bin";
+    return writePointsBinary(puntos, archivo, true) ? archivo : "";
+}
+
+OutputMode outputModeRequested() {
+    const char* valor = std::getenv("DBSCAN_OUTPUT");
+    if (valor == nullptr) {
+        return OutputMode::Completa;
+    }
+    if (std::strcmp(valor, "etiquetas") == 0) {
+        return OutputMode::Etiquetas;
+    }
+    if (std::strcmp(valor, "etiquetas_bin") == 0) {
+        return OutputMode::EtiquetasBinario;
+    }
+    return OutputMode::Completa;
+}
+
+std::string writeLabelsOnly(const std::vector<Point>& puntos,
+                            const std::string& output_dir,
+                            const std::string& etiqueta,
+                            bool binario) {
+    namespace fs = std::filesystem;
+    if (!fs::exists(output_dir)) {
+        fs::create_directories(output_dir);
+    }
+    const std::string archivo = output_dir + "/" + std::to_string(puntos.size()) + "_labels_" + etiqueta +
+                                (binario ? ".bin" : ".csv");
+    const bool ok = binario ? writeLabelsBinary(puntos, archivo) : writePointsCSV(puntos, archivo, false);
+    return ok ? archivo : "";
+}
@@ -0,0 +1,269 @@
+#include "kdtree.hpp"
+#include "clusterer.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <numeric>
+
+using std::size_t;
+
+namespace {
+
+// Subárboles con más puntos que esto se construyen en una tarea aparte.
+constexpr size_t KD_TAREA_MIN = size_t{1} << 14;
+
+// Dimensión máxima con poda por cajas (buffers en la pila); por encima se recorre todo.
+constexpr size_t KD_DIMS_MAX = 64;
+
+}
+
+void KdTree::build(const double* coords, size_t n, size_t dims, size_t hoja) {
+    dims_ = dims;
+    hoja_ = std::max<size_t>(1, hoja);
+    fuente_ = coords;
+    indice_.resize(n);
+    std::iota(indice_.begin(), indice_.end(), size_t{0});
+    nodos_.clear();
+    cajas_.clear();
+    datos_.resize(n * dims);
+    if (n == 0 || dims == 0) {
+        fuente_ = nullptr;
+        return;
+    }
+
+    // Con cortes por la mediana cada hoja tiene más de hoja/2 puntos, así que el
+    // número de nodos está acotado y se pueden reservar antes de lanzar las tareas.
+    const size_t max_nodos = 4 * (n / hoja_ + 1);
+    nodos_.resize(max_nodos);
+    cajas_.resize(max_nodos * 2 * dims);
+    siguiente_ = 0;
+
+#pragma omp parallel
+#pragma omp single
+    buildNode(0, n, 0);
+
+    nodos_.resize(siguiente_);
+    cajas_.resize(siguiente_ * 2 * dims);
+
+#pragma omp parallel for schedule(static)
+    for (size_t pos = 0; pos < n; ++pos) {
+        std::copy_n(coords + indice_[pos] * dims, dims, &datos_[pos * dims]);
+    }
+    fuente_ = nullptr;
+}
+
+size_t KdTree::buildNode(size_t inicio, size_t fin, size_t profundidad) {
+    size_t id;
+#pragma omp atomic capture
+    id = siguiente_++;
+
+    double* minimos = &cajas_[id * 2 * dims_];
+    double* maximos = minimos + dims_;
+    std::copy_n(fuente_ + indice_[inicio] * dims_, dims_, minimos);
+    std::copy_n(fuente_ + indice_[inicio] * dims_, dims_, maximos);
+    for (size_t pos = inicio + 1; pos < fin; ++pos) {
+        const double* p = fuente_ + indice_[pos] * dims_;
+        for (size_t k = 0; k < dims_; ++k) {
+            minimos[k] = std::min(minimos[k], p[k]);
+            maximos[k] = std::max(maximos[k], p[k]);
+        }
+    }
+
+    Nodo& nodo = nodos_[id];
+    nodo.inicio = inicio;
+    nodo.fin = fin;
+    nodo.izq = 0;
+    nodo.der = 0;
+    if (fin - inicio <= hoja_) {
+        return id;
+    }
+
+    // Corte por la mediana de la dimensión más extendida de la caja.
+    size_t eje = 0;
+    for (size_t k = 1; k < dims_; ++k) {
+        if (maximos[k] - minimos[k] > maximos[eje] - minimos[eje]) {
+            eje = k;
+        }
+    }
+    const size_t medio = inicio + (fin - inicio) / 2;
+    const double* fuente = fuente_;
+    const size_t dims = dims_;
+    std::nth_element(indice_.begin() + static_cast<std::ptrdiff_t>(inicio),
+                     indice_.begin() + static_cast<std::ptrdiff_t>(medio),
+                     indice_.begin() + static_cast<std::ptrdiff_t>(fin),
+                     [fuente, dims, eje](size_t a, size_t b) {
+                         return fuente[a * dims + eje] < fuente[b * dims + eje];
+                     });
+
+    size_t izq = 0;
+    size_t der = 0;
+    if (fin - inicio > KD_TAREA_MIN) {
+#pragma omp task shared(izq) firstprivate(inicio, medio, profundidad)
+        izq = buildNode(inicio, medio, profundidad + 1);
+        der = buildNode(medio, fin, profundidad + 1);
+#pragma omp taskwait
+    } else {
+        izq = buildNode(inicio, medio, profundidad + 1);
+        der = buildNode(medio, fin, profundidad + 1);
+    }
+    // nodos_ no se realoja durante la construcción, así que la referencia sigue válida.
+    nodo.izq = izq;
+    nodo.der = der;
+    return id;
+}
+
+// Las distancias a la caja se evalúan con distanceSquaredN sobre un punto construido
+// con coordenadas de la propia caja; como el redondeo es monótono, la cota nunca
+// descarta (ni acepta en bloque) un punto que la comparación directa trataría distinto.
+double KdTree::minDistance(size_t nodo, const double* q) const {
+    if (dims_ > KD_DIMS_MAX) {
+        return 0.0;
+    }
+    const double* minimos = &cajas_[nodo * 2 * dims_];
+    const double* maximos = minimos + dims_;
+    double cercano[KD_DIMS_MAX];
+    for (size_t k = 0; k < dims_; ++k) {
+        cercano[k] = std::min(std::max(q[k], minimos[k]), maximos[k]);
+    }
+    return distanceSquaredN(q, cercano, dims_);
+}
+
+double KdTree::maxDistance(size_t nodo, const double* q) const {
+    const double* minimos = &cajas_[nodo * 2 * dims_];
+    const double* maximos = minimos + dims_;
+    double esquina[KD_DIMS_MAX];
+    for (size_t k = 0; k < dims_; ++k) {
+        esquina[k] = q[k] - minimos[k] > maximos[k] - q[k] ? minimos[k] : maximos[k];
+    }
+    return distanceSquaredN(q, esquina, dims_);
+}
+
+size_t KdTree::countWithin(const double* q, double eps2, size_t limite) const {
+    if (nodos_.empty()) {
+        return 0;
+    }
+    size_t total = 0;
+    size_t pila[128];
+    size_t tope = 0;
+    pila[tope++] = 0;
+    while (tope > 0 && total < limite) {
+        const size_t id = pila[--tope];
+        const Nodo& nodo = nodos_[id];
+        if (minDistance(id, q) > eps2) {
+            continue;
+        }
+        if (dims_ <= KD_DIMS_MAX && maxDistance(id, q) <= eps2) {
+            total += nodo.fin - nodo.inicio;
+            continue;
+        }
+        if (nodo.izq == 0) {
+            for (size_t pos = nodo.inicio; pos < nodo.fin && total < limite; ++pos) {
+                total += distanceSquaredN(q, coord(pos), dims_) <= eps2;
+            }
+            continue;
+        }
+        pila[tope++] = nodo.der;
+        pila[tope++] = nodo.izq;
+    }
+    return std::min(total, limite);
+}
+
+void markCoresKdTree(const KdTree& arbol, const double* coords, size_t n, double epsilon, int min_samples, char* es_core) {
+    const double eps2 = epsilon * epsilon;
+    const size_t dims = arbol.dims();
+    // La consulta incluye al propio punto, por eso el tope es min_samples + 1.
+    const size_t limite = static_cast<size_t>(std::max(min_samples, 0)) + 1;
+
+#pragma omp parallel for schedule(dynamic, 256)
+    for (size_t i = 0; i < n; ++i) {
+        es_core[i] = arbol.countWithin(coords + i * dims, eps2, limite) >= limite;
+    }
+}
+
+void labelFromCoresKdTree(const KdTree& arbol, const double* coords, size_t n, double epsilon, const char* core, int* labels) {
+    const double eps2 = epsilon * epsilon;
+    const size_t dims = arbol.dims();
+#pragma omp parallel for schedule(dynamic, 256)
+    for (size_t i = 0; i < n; ++i) {
+        if (core[i]) {
+            labels[i] = CORE1;
+        } else if (arbol.anyWithin(coords + i * dims, eps2, [core](size_t j) { return core[j] != 0; })) {
+            labels[i] = CORE2;
+        } else {
+            labels[i] = NOISE;
+        }
+    }
+}
+
+void labelWithKdTree(const KdTree& arbol, const double* coords, size_t n, double epsilon, int min_samples, int* labels) {
+    std::vector<char> es_core(n, 0);
+    markCoresKdTree(arbol, coords, n, epsilon, min_samples, es_core.data());
+    labelFromCoresKdTree(arbol, coords, n, epsilon, es_core.data(), labels);
+}
+
+std::vector<int> dbscanLabelsKdTree(const double* coords, size_t n, size_t dims, double epsilon, int min_samples, int num_threads) {
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+    std::vector<int> labels(n, NOISE);
+    if (n == 0 || dims == 0) {
+        return labels;
+    }
+    KdTree arbol;
+    arbol.build(coords, n, dims);
+    labelWithKdTree(arbol, coords, n, epsilon, min_samples, labels.data());
+    return labels;
+}
+
+void dbscan_kdtree(std::vector<Point>& puntos,
+                   double epsilon,
+                   int min_samples,
+                   int num_threads,
+                   Workspace& ws) {
+    PhaseClock reloj(ws.perf);
+    ws.fases = PhaseTimes{};
+    resetLabels(puntos);
+    const size_t n = puntos.size();
+    if (n == 0) {
+        return;
+    }
+
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+
+    std::vector<double>& coords = ws.coords;
+    coords.resize(2 * n);
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        coords[2 * i] = puntos[i].x;
+        coords[2 * i + 1] = puntos[i].y;
+    }
+
+    ws.kdtree.build(coords.data(), n, 2);
+    ws.etiquetas.resize(n);
+    firstTouchAssign(ws.es_core, n, char{0});
+    ws.fases.preparacion = reloj.lap(ws.perf.preparacion);
+
+    // El conteo se corta en min_samples, así que marca los cores en la misma pasada.
+    markCoresKdTree(ws.kdtree, coords.data(), n, epsilon, min_samples, ws.es_core.data());
+    ws.fases.conteo = reloj.lap(ws.perf.conteo);
+
+    labelFromCoresKdTree(ws.kdtree, coords.data(), n, epsilon, ws.es_core.data(), ws.etiquetas.data());
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        puntos[i].label = ws.etiquetas[i];
+    }
+    ws.fases.frontera = reloj.lap(ws.perf.frontera);
+}
+
+std::vector<Point> dbscan_kdtree(const std::string& ruta,
+                                 double epsilon,
+                                 int min_samples,
+                                 int num_threads) {
+    std::vector<Point> puntos = loadPoints(ruta);
+    Workspace ws;
+    dbscan_kdtree(puntos, epsilon, min_samples, num_threads, ws);
+    return puntos;
+}
@@ -1,4 +1,19 @@
 #include "dbscan.hpp"
+#include "approx.hpp"
+#include "autotune.hpp"
+#include "clusterer.hpp"
+#include "dbscan_nd.hpp"
+#include "distributed.hpp"
+#include "generate.hpp"
+#include "io.hpp"
+#include "numa.hpp"
+#include "outofcore.hpp"
+#include "perf.hpp"
+#include "server.hpp"
+#include "soa.hpp"
+#include "stream.hpp"
+#include "sweep.hpp"
+#include "verify.hpp"
 
 #include <omp.h>
 
@@ -6,35 +21,67 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <set>
 #include <string>
 #include <vector>
 #include <algorithm>
 #include <filesystem>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 
 namespace {
-    std::size_t countMismatches(const std::vector<Point> &a, const std::vector<Point> &b) {
-        if (a.size() != b.size()) {
-            return std::max(a.size(), b.size());
+    // La salida usa el mismo formato que la entrada: .bin -> binario, otro -> CSV.
+    // Con DBSCAN_OUTPUT=etiquetas|etiquetas_bin no se repiten las coordenadas.
+    std::string writeResultsFor(const std::string &ruta,
+                                const std::vector<Point> &puntos,
+                                const std::string &output_dir,
+                                const std::string &etiqueta) {
+        const OutputMode modo = outputModeRequested();
+        if (modo != OutputMode::Completa) {
+            return writeLabelsOnly(puntos, output_dir, etiqueta,
+                                   modo == OutputMode::EtiquetasBinario || isBinaryPath(ruta));
         }
-        std::size_t mismatches = 0;
-        for (std::size_t i = 0; i < a.size(); ++i) {
-            if (a[i].label != b[i].label) {
-                ++mismatches;
+        return isBinaryPath(ruta)
+            ? writeResultsBinary(puntos, output_dir, etiqueta)
+            : writeResultsCSV(puntos, output_dir, etiqueta);
+    }
+
+    // Números separados por coma ("0.01,0.02,0.03"); las partes vacías se ignoran.
+    std::vector<double> parseNumberList(const std::string &lista) {
+        std::vector<double> valores;
+        std::stringstream partes(lista);
+        for (std::string parte; std::getline(partes, parte, ',');) {
+            if (!parte.empty()) {
+                valores.push_back(std::stod(parte));
             }
         }
-        return mismatches;
+        return valores;
     }
 
     struct Stats {
         double mean{};
         double stdev{};
+        double median{};
+        double p10{};
+        double p90{};
     };
 
+    // Percentil por rango más cercano sobre tiempos ya ordenados.
+    double percentile(const std::vector<double> &ordenados, double p) {
+        const double pos = p * static_cast<double>(ordenados.size() - 1);
+        return ordenados[static_cast<std::size_t>(std::lround(pos))];
+    }
+
     Stats computeStats(const std::vector<double> &tiempos) {
         if (tiempos.empty()) {
-            return {0.0, 0.0};
+            return {};
         }
         double suma = 0.0;
         for (double t : tiempos) {
@@ -48,92 +95,685 @@ namespace {
             var += diff * diff;
         }
         var /= static_cast<double>(tiempos.size());
-        return {mean, std::sqrt(var)};
-    }
-
-    Stats runSerial(const std::string &ruta,
-                    double epsilon,
-                    int min_samples,
-                    int iterations,
-                    std::vector<double> &tiempos,
-                    const std::string &output_dir,
-                    std::vector<Point> &ultimo_serial) {
-        tiempos.clear();
-        tiempos.reserve(iterations);
-        for (int i = 0; i < iterations; ++i) {
-            const double inicio = omp_get_wtime();
-            ultimo_serial = dbscan_serial(ruta, epsilon, min_samples);
-            tiempos.push_back(omp_get_wtime() - inicio);
+
+        std::vector<double> ordenados = tiempos;
+        std::sort(ordenados.begin(), ordenados.end());
+        return {mean, std::sqrt(var), percentile(ordenados, 0.5), percentile(ordenados, 0.1), percentile(ordenados, 0.9)};
+    }
+
+    double medianOf(std::vector<double> valores) {
+        if (valores.empty()) {
+            return 0.0;
+        }
+        std::sort(valores.begin(), valores.end());
+        return percentile(valores, 0.5);
+    }
+
+    // Resultado de medir un motor: tiempos del algoritmo, mediana de cada fase entre
+    // iteraciones y el tiempo de escribir la salida (fuera de las iteraciones).
+    // Con DBSCAN_PERF, perf trae los contadores de la iteración de tiempo mediano.
+    struct Medicion {
+        Stats total;
+        PhaseTimes fases;
+        double escritura{};
+        PerfReport perf;
+    };
+
+    const char *displayName(Engine engine) {
+        switch (engine) {
+        case Engine::Serial:
+            return "serial";
+        case Engine::ParallelFull:
+            return "paralelo1";
+        case Engine::ParallelDivided:
+            return "paralelo2";
+        case Engine::ParallelTasks:
+            return "tareas";
+        default:
+            return engineName(engine);
         }
-        const std::string salida =
-            writeResultsCSV(ultimo_serial, output_dir, "serial");
-        std::cout << "  -> serial guardó: " << salida << '\n';
-        return computeStats(tiempos);
     }
 
-    Stats runParallelFull(const std::string &ruta,
+    // Corre un Clusterer ya configurado sobre una copia de los puntos ya cargados: el
+    // tiempo medido solo incluye el algoritmo, y el Clusterer reutiliza sus buffers
+    // entre corridas. Las corridas de calentamiento no se miden; la salida se escribe
+    // una vez al final.
+    Medicion runClusterer(Clusterer &clusterer,
+                          const std::string &ruta,
+                          const std::vector<Point> &puntos,
                           double epsilon,
                           int min_samples,
-                          int threads,
+                          int warmup,
                           int iterations,
-                          std::vector<double> &tiempos,
                           const std::string &output_dir,
                           std::vector<Point> &ultimo,
-                          const std::vector<Point> &referencia_serial) {
+                          const std::vector<Point> *referencia_serial) {
+        const Engine engine = clusterer.engine();
+        const int threads = clusterer.threads();
         if (threads > 0) {
             omp_set_num_threads(threads);
         }
-        tiempos.clear();
-        tiempos.reserve(iterations);
+        // Con DBSCAN_AFFINITY los hilos se fijan antes de que el motor toque sus
+        // buffers, y la copia de los puntos se reparte entre los nodos de esos hilos.
+        const Affinity afinidad = affinityRequested();
+        pinThreads(afinidad, threads);
+        clusterer.setPerf(perfRequested());
+        clusterer.setCurve(curveRequested());
+        ultimo = puntos;
+        if (afinidad != Affinity::Ninguna) {
+            partitionPages(ultimo.data(), ultimo.size() * sizeof(Point));
+        }
+        for (int i = 0; i < warmup; ++i) {
+            clusterer.run(ultimo, epsilon, min_samples);
+        }
+
+        std::vector<double> tiempos;
+        std::vector<double> preparacion, conteo, cores, frontera;
+        std::vector<PerfReport> reportes;
         for (int i = 0; i < iterations; ++i) {
             const double inicio = omp_get_wtime();
-            ultimo = dbscan_parallel_full(ruta, epsilon, min_samples, threads);
+            clusterer.run(ultimo, epsilon, min_samples);
             tiempos.push_back(omp_get_wtime() - inicio);
+            const PhaseTimes &f = clusterer.phases();
+            preparacion.push_back(f.preparacion);
+            conteo.push_back(f.conteo);
+            cores.push_back(f.cores);
+            frontera.push_back(f.frontera);
+            if (clusterer.perf().activo) {
+                reportes.push_back(clusterer.perf());
+            }
         }
+
+        Medicion medicion;
+        medicion.total = computeStats(tiempos);
+        if (!reportes.empty()) {
+            std::vector<std::size_t> orden(tiempos.size());
+            for (std::size_t k = 0; k < orden.size(); ++k) {
+                orden[k] = k;
+            }
+            std::sort(orden.begin(), orden.end(), [&](std::size_t a, std::size_t b) { return tiempos[a] < tiempos[b]; });
+            medicion.perf = reportes[orden[static_cast<std::size_t>(std::lround(0.5 * static_cast<double>(orden.size() - 1)))]];
+        }
+        medicion.fases.preparacion = medianOf(preparacion);
+        medicion.fases.conteo = medianOf(conteo);
+        medicion.fases.cores = medianOf(cores);
+        medicion.fases.frontera = medianOf(frontera);
+        medicion.fases.pares = clusterer.phases().pares;
+
+        // La columna cluster de la salida sale de las etiquetas de la última corrida.
+        assignClusters(ultimo, epsilon, threads);
+        const double inicio_escritura = omp_get_wtime();
         const std::string salida =
-            writeResultsCSV(ultimo, output_dir, "parallel_full");
-        std::cout << "  -> paralelo1 guardó: " << salida << '\n';
+            writeResultsFor(ruta, ultimo, output_dir, engineName(engine));
+        medicion.escritura = omp_get_wtime() - inicio_escritura;
+        std::cout << "  -> " << displayName(engine) << " guardó: " << salida << '\n';
 
-        const std::size_t mismatches = countMismatches(referencia_serial, ultimo);
-        if (mismatches != 0) {
-            std::cout << "  (!) " << mismatches
-                      << " etiquetas difieren entre serial y paralelo1.\n";
+        if (referencia_serial != nullptr) {
+            const std::size_t mismatches = countMismatches(*referencia_serial, ultimo);
+            if (mismatches != 0) {
+                std::cout << "  (!) " << mismatches
+                          << " etiquetas difieren entre serial y " << displayName(engine) << ".\n";
+            }
         }
 
-        return computeStats(tiempos);
+        return medicion;
     }
 
-    Stats runParallelDivided(const std::string &ruta,
-                             double epsilon,
-                             int min_samples,
-                             int threads,
-                             int iterations,
-                             std::size_t block_size,
-                             std::vector<double> &tiempos,
-                             const std::string &output_dir,
-                             std::vector<Point> &ultimo,
-                             const std::vector<Point> &referencia_serial) {
-        if (threads > 0) {
-            omp_set_num_threads(threads);
+    Medicion runEngine(Engine engine,
+                       const std::string &ruta,
+                       const std::vector<Point> &puntos,
+                       double epsilon,
+                       int min_samples,
+                       int threads,
+                       int warmup,
+                       int iterations,
+                       std::size_t block_size,
+                       const std::string &output_dir,
+                       std::vector<Point> &ultimo,
+                       const std::vector<Point> *referencia_serial) {
+        Clusterer clusterer(engine, threads, block_size);
+        return runClusterer(clusterer, ruta, puntos, epsilon, min_samples, warmup, iterations, output_dir, ultimo,
+                            referencia_serial);
+    }
+
+    // Distancias evaluadas por segundo de conteo y GB/s de coordenadas que recorre el
+    // núcleo de distancias (16 bytes por par). Negativo si el motor no cuenta pares.
+    double pairsPerSecond(const PhaseTimes &f) {
+        return f.pares > 0.0 && f.conteo > 0.0 ? f.pares / f.conteo : -1.0;
+    }
+
+    double gigabytesPerSecond(const PhaseTimes &f) {
+        const double pares = pairsPerSecond(f);
+        return pares < 0.0 ? -1.0 : pares * 2.0 * sizeof(double) / 1e9;
+    }
+
+    // Fases del PerfReport con los nombres de columna del benchmark.
+    std::vector<std::pair<const char *, const PhasePerf *>> perfPhases(const PerfReport &perf) {
+        return {{"prepare", &perf.preparacion}, {"count", &perf.conteo}, {"core", &perf.cores}, {"border", &perf.frontera}};
+    }
+
+    void printCounts(std::ostream &out, const PerfCounts &c) {
+        static const char *const nombres[PERF_EVENTOS] = {"ciclos", "instr", "fallos LLC", "fallos rama"};
+        for (int e = 0; e < PERF_EVENTOS; ++e) {
+            if (c.valido[e]) {
+                out << "  " << nombres[e] << ' ' << c.valores[e];
+            }
         }
-        tiempos.clear();
-        tiempos.reserve(iterations);
-        for (int i = 0; i < iterations; ++i) {
+        if (c.ipc() >= 0.0) {
+            out << std::setprecision(2) << "  IPC " << c.ipc();
+        }
+    }
+
+    // Totales por fase y, para el conteo de vecinos (donde están los bucles de pares),
+    // el detalle por hilo con su tiempo ocupado y ocioso.
+    void printPerf(std::ostream &out, const char *motor, const PerfReport &perf) {
+        out << std::fixed << "Contadores " << motor << ":\n";
+        for (const auto &[nombre, fase] : perfPhases(perf)) {
+            if (fase->hilos.empty()) {
+                continue;
+            }
+            out << "  " << std::left << std::setw(8) << nombre << std::right << std::setprecision(6)
+                << fase->pared << " s";
+            printCounts(out, fase->total());
+            if (fase->busyMean() > 0.0) {
+                out << std::setprecision(2) << "  ocupado max/media " << fase->busyMax() / fase->busyMean()
+                    << "  ocioso " << 100.0 * fase->idleFraction() << "%";
+            }
+            out << '\n';
+        }
+        const PhasePerf &conteo = perf.conteo;
+        for (std::size_t h = 0; h < conteo.hilos.size(); ++h) {
+            out << "    hilo " << std::setw(3) << h;
+            if (h < conteo.ocupado.size()) {
+                out << std::setprecision(6) << "  ocupado " << conteo.ocupado[h]
+                    << " s  ocioso " << std::max(0.0, conteo.pared - conteo.ocupado[h]) << " s";
+            }
+            printCounts(out, conteo.hilos[h]);
+            out << '\n';
+        }
+        if (!perf.conteo.total().any()) {
+            out << "  (contadores de hardware no disponibles: revisa kernel.perf_event_paranoid)\n";
+        }
+    }
+
+    struct BenchRow {
+        std::string entrada;
+        std::size_t puntos{};
+        int hilos{};
+        std::string modo;
+        double carga{};
+        Medicion medicion;
+        bool generada{};  // la entrada no estaba en data/input y se generó con --generate blobs
+    };
+
+    std::string jsonNumber(double valor) {
+        if (valor < 0.0 || !std::isfinite(valor)) {
+            return "null";
+        }
+        std::ostringstream out;
+        out << std::setprecision(9) << valor;
+        return out.str();
+    }
+
+    std::string jsonString(const std::string &texto) {
+        std::string salida = "\"";
+        for (char c : texto) {
+            if (c == '"' || c == '\\') {
+                salida += '\\';
+            }
+            salida += c;
+        }
+        return salida + "\"";
+    }
+
+    void writePerfCountsJSON(std::ostream &out, const PerfCounts &c) {
+        for (int e = 0; e < PERF_EVENTOS; ++e) {
+            out << ", " << jsonString(perfEventName(e)) << ": "
+                << (c.valido[e] ? std::to_string(c.valores[e]) : std::string("null"));
+        }
+    }
+
+    bool writeBenchmarkJSON(const std::string &archivo,
+                            double epsilon,
+                            int min_samples,
+                            int warmup,
+                            int iterations,
+                            std::size_t block_size,
+                            const std::vector<BenchRow> &filas) {
+        std::ofstream out(archivo);
+        if (!out) {
+            return false;
+        }
+        out << "{\n"
+            << "  \"cpu\": " << jsonString(cpuModel()) << ",\n"
+            << "  \"simd\": " << jsonString(simdKernelName()) << ",\n"
+            << "  \"curve\": " << jsonString(curveName(curveRequested())) << ",\n"
+            << "  \"affinity\": " << jsonString(affinityName(affinityRequested())) << ",\n"
+            << "  \"numa_nodes\": " << numaTopology().nodes() << ",\n"
+            << "  \"epsilon\": " << jsonNumber(epsilon) << ",\n"
+            << "  \"min_samples\": " << min_samples << ",\n"
+            << "  \"warmup\": " << warmup << ",\n"
+            << "  \"iterations\": " << iterations << ",\n"
+            << "  \"block_size\": " << block_size << ",\n"
+            << "  \"results\": [";
+        for (std::size_t k = 0; k < filas.size(); ++k) {
+            const BenchRow &f = filas[k];
+            const Medicion &m = f.medicion;
+            out << (k == 0 ? "\n" : ",\n")
+                << "    {\"input\": " << jsonString(f.entrada)
+                << ", \"points\": " << f.puntos
+                << ", \"generated\": " << (f.generada ? "true" : "false")
+                << ", \"threads\": " << f.hilos
+                << ", \"mode\": " << jsonString(f.modo)
+                << ", \"time\": {\"mean\": " << jsonNumber(m.total.mean)
+                << ", \"std\": " << jsonNumber(m.total.stdev)
+                << ", \"median\": " << jsonNumber(m.total.median)
+                << ", \"p10\": " << jsonNumber(m.total.p10)
+                << ", \"p90\": " << jsonNumber(m.total.p90) << "}"
+                << ", \"phases\": {\"load\": " << jsonNumber(f.carga)
+                << ", \"prepare\": " << jsonNumber(m.fases.preparacion)
+                << ", \"count\": " << jsonNumber(m.fases.conteo)
+                << ", \"core\": " << jsonNumber(m.fases.cores)
+                << ", \"border\": " << jsonNumber(m.fases.frontera)
+                << ", \"write\": " << jsonNumber(m.escritura) << "}"
+                << ", \"pairs\": " << jsonNumber(m.fases.pares > 0.0 ? m.fases.pares : -1.0)
+                << ", \"pairs_per_s\": " << jsonNumber(pairsPerSecond(m.fases))
+                << ", \"gb_per_s\": " << jsonNumber(gigabytesPerSecond(m.fases));
+            if (m.perf.activo) {
+                out << ", \"perf\": {";
+                bool primera = true;
+                for (const auto &[nombre, fase] : perfPhases(m.perf)) {
+                    if (fase->hilos.empty()) {
+                        continue;
+                    }
+                    out << (primera ? "" : ", ") << jsonString(nombre) << ": {\"wall\": " << jsonNumber(fase->pared);
+                    writePerfCountsJSON(out, fase->total());
+                    out << ", \"threads\": [";
+                    for (std::size_t h = 0; h < fase->hilos.size(); ++h) {
+                        out << (h == 0 ? "{" : ", {") << "\"busy\": "
+                            << jsonNumber(h < fase->ocupado.size() ? fase->ocupado[h] : -1.0);
+                        writePerfCountsJSON(out, fase->hilos[h]);
+                        out << "}";
+                    }
+                    out << "]}";
+                    primera = false;
+                }
+                out << "}";
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    void writeBenchmarkCSVRow(std::ostream &csv, const BenchRow &f) {
+        const Medicion &m = f.medicion;
+        auto opcional = [&](double valor) {
+            if (valor >= 0.0) {
+                csv << valor;
+            }
+        };
+        csv << f.puntos << ',' << f.hilos << ',' << f.modo << ','
+            << m.total.mean << ',' << m.total.stdev << ','
+            << m.total.median << ',' << m.total.p10 << ',' << m.total.p90 << ','
+            << f.carga << ',' << m.fases.preparacion << ',' << m.fases.conteo << ','
+            << m.fases.cores << ',' << m.fases.frontera << ',' << m.escritura << ',';
+        opcional(pairsPerSecond(m.fases));
+        csv << ',';
+        opcional(gigabytesPerSecond(m.fases));
+        // Contadores por fase y reparto del conteo; vacíos sin DBSCAN_PERF o sin soporte.
+        for (const auto &fase : perfPhases(m.perf)) {
+            const PerfCounts total = fase.second->total();
+            for (int e = 0; e < PERF_EVENTOS; ++e) {
+                csv << ',';
+                if (total.valido[e]) {
+                    csv << total.valores[e];
+                }
+            }
+        }
+        csv << ',';
+        opcional(m.perf.conteo.busyMax());
+        csv << ',';
+        opcional(m.perf.conteo.busyMean());
+        csv << ',';
+        opcional(m.perf.conteo.idleFraction());
+        csv << '\n';
+        csv.flush();
+    }
+
+    std::string benchmarkCSVHeader() {
+        std::string header = "points,threads,mode,time_avg,time_std,time_median,time_p10,time_p90,"
+                             "load,prepare,count,core,border,write,pairs_per_s,gb_per_s";
+        for (const auto &fase : perfPhases(PerfReport{})) {
+            for (int e = 0; e < PERF_EVENTOS; ++e) {
+                header += std::string(",") + fase.first + "_" + perfEventName(e);
+            }
+        }
+        return header + ",count_busy_max,count_busy_mean,count_idle";
+    }
+
+    // Una fila por fase e hilo con contadores y tiempo ocupado/ocioso (solo DBSCAN_PERF).
+    void writeThreadCSVRows(std::ostream &csv, const BenchRow &f) {
+        for (const auto &[nombre, fase] : perfPhases(f.medicion.perf)) {
+            for (std::size_t h = 0; h < fase->hilos.size(); ++h) {
+                csv << f.puntos << ',' << f.hilos << ',' << f.modo << ',' << nombre << ',' << h << ',';
+                if (h < fase->ocupado.size()) {
+                    csv << fase->ocupado[h] << ',' << std::max(0.0, fase->pared - fase->ocupado[h]);
+                } else {
+                    csv << ',';
+                }
+                for (int e = 0; e < PERF_EVENTOS; ++e) {
+                    csv << ',';
+                    if (fase->hilos[h].valido[e]) {
+                        csv << fase->hilos[h].valores[e];
+                    }
+                }
+                csv << '\n';
+            }
+        }
+        csv.flush();
+    }
+
+    // Motores de --nd: los tres algoritmos genéricos y el k-d tree.
+    struct NdEngines {
+        bool serial = true;
+        bool full = true;
+        bool divided = true;
+        bool kdtree = true;
+    };
+
+    // "todos" o una lista separada por comas de serial, parallel_full,
+    // parallel_divided y kdtree. Devuelve false si algún nombre no existe.
+    bool parseNdEngines(const std::string &lista, NdEngines &motores) {
+        if (lista == "todos") {
+            motores = NdEngines{};
+            return true;
+        }
+        motores = NdEngines{false, false, false, false};
+        std::stringstream partes(lista);
+        for (std::string parte; std::getline(partes, parte, ',');) {
+            if (parte == "serial") {
+                motores.serial = true;
+            } else if (parte == "parallel_full") {
+                motores.full = true;
+            } else if (parte == "parallel_divided") {
+                motores.divided = true;
+            } else if (parte == "kdtree") {
+                motores.kdtree = true;
+            } else if (!parte.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Corre los motores elegidos con escalar T y dimensión D y, si el serial está
+    // entre ellos, compara las etiquetas de los demás contra las suyas.
+    template <typename T, int D>
+    int runNd(std::vector<T> coords, std::size_t dims, double epsilon, int min_samples, int num_threads,
+              const NdEngines &motores) {
+        PointSetN<T, D> conjunto;
+        conjunto.coords = std::move(coords);
+        conjunto.dims = dims;
+        const T eps = static_cast<T>(epsilon);
+
+        std::cout << std::fixed << std::setprecision(6)
+                  << "Puntos: " << conjunto.size() << "  dims: " << dims
+                  << "  escalar: " << (sizeof(T) == 4 ? "float" : "double")
+                  << "  núcleo: " << (D == DIM_DINAMICA ? "dinámico" : "desenrollado") << '\n';
+
+        std::vector<int> referencia;
+        double t_serial = 0.0;
+        if (motores.serial) {
             const double inicio = omp_get_wtime();
-            ultimo = dbscan_parallel_divided(ruta, epsilon, min_samples, threads, block_size);
-            tiempos.push_back(omp_get_wtime() - inicio);
+            dbscanSerialN(conjunto, eps, min_samples);
+            t_serial = omp_get_wtime() - inicio;
+            referencia = conjunto.labels;
+            const std::size_t cores = static_cast<std::size_t>(std::count(referencia.begin(), referencia.end(), CORE1));
+            const std::size_t ruido = static_cast<std::size_t>(std::count(referencia.begin(), referencia.end(), NOISE));
+            std::cout << "Cores: " << cores << "  ruido: " << ruido << '\n'
+                      << "Serial:    " << t_serial << " s\n";
+        }
+
+        bool iguales = true;
+        auto reportar = [&](const char *nombre, double tiempo, const std::vector<int> &etiquetas,
+                            const std::vector<int> &contra) {
+            std::cout << nombre << tiempo << " s";
+            if (!contra.empty()) {
+                std::size_t difieren = 0;
+                for (std::size_t i = 0; i < contra.size(); ++i) {
+                    difieren += contra[i] != etiquetas[i];
+                }
+                std::cout << "  speedup " << t_serial / tiempo << "  difieren: " << difieren;
+                iguales = iguales && difieren == 0;
+            }
+            std::cout << '\n';
+        };
+
+        if (motores.full) {
+            const double inicio = omp_get_wtime();
+            dbscanParallelFullN(conjunto, eps, min_samples, num_threads);
+            reportar("Paralelo1: ", omp_get_wtime() - inicio, conjunto.labels, referencia);
+        }
+        if (motores.divided) {
+            const double inicio = omp_get_wtime();
+            dbscanParallelDividedN(conjunto, eps, min_samples, num_threads);
+            reportar("Paralelo2: ", omp_get_wtime() - inicio, conjunto.labels, referencia);
+        }
+        if (motores.kdtree) {
+            // El árbol trabaja en double: con float se copia, y los pares a distancia
+            // casi exactamente eps pueden quedar de otro lado que en el serial float.
+            // Por eso se compara contra un serial double sobre la misma copia.
+            std::vector<int> etiquetas;
+            if constexpr (std::is_same_v<T, double>) {
+                const double inicio = omp_get_wtime();
+                etiquetas = dbscanLabelsKdTree(conjunto.coords.data(), conjunto.size(), dims, epsilon, min_samples,
+                                               num_threads);
+                reportar("k-d tree:  ", omp_get_wtime() - inicio, etiquetas, referencia);
+            } else {
+                PointSetN<double, D> copia;
+                copia.coords.assign(conjunto.coords.begin(), conjunto.coords.end());
+                copia.dims = dims;
+                const double inicio = omp_get_wtime();
+                etiquetas = dbscanLabelsKdTree(copia.coords.data(), copia.size(), dims, static_cast<double>(eps),
+                                               min_samples, num_threads);
+                const double tiempo = omp_get_wtime() - inicio;
+                if (!referencia.empty()) {
+                    dbscanSerialN(copia, static_cast<double>(eps), min_samples);
+                }
+                reportar("k-d tree:  ", tiempo, etiquetas, copia.labels);
+                if (!referencia.empty()) {
+                    std::cout << "  (k-d tree comparado contra el serial en double)\n";
+                }
+            }
         }
+        return iguales ? 0 : 1;
+    }
+
+    // Lee líneas "x,y" de fd y las entrega en lotes de hasta `lote` puntos. Cuando
+    // read no devuelve datos se procesa lo pendiente; si es un archivo y espera > 0 se
+    // vuelve a intentar hasta que pasen `espera` segundos sin que crezca.
+    template <typename F>
+    void readBatches(int fd, bool es_archivo, std::size_t lote, double espera, F&& procesar) {
+        std::vector<char> buffer(std::size_t{1} << 20);
+        std::string resto;
+        std::vector<Point> pendientes;
+        auto entregar = [&](bool todo) {
+            std::size_t desde = 0;
+            while (pendientes.size() - desde >= lote || (todo && desde < pendientes.size())) {
+                const std::size_t hasta = std::min(pendientes.size(), desde + lote);
+                procesar(std::vector<Point>(pendientes.begin() + static_cast<std::ptrdiff_t>(desde),
+                                            pendientes.begin() + static_cast<std::ptrdiff_t>(hasta)));
+                desde = hasta;
+            }
+            pendientes.erase(pendientes.begin(), pendientes.begin() + static_cast<std::ptrdiff_t>(desde));
+        };
+
+        double sin_datos_desde = omp_get_wtime();
+        while (true) {
+            const ssize_t leidos = ::read(fd, buffer.data(), buffer.size());
+            if (leidos > 0) {
+                resto.append(buffer.data(), static_cast<std::size_t>(leidos));
+                const std::size_t corte = resto.rfind('\n');
+                if (corte != std::string::npos) {
+                    const std::vector<Point> nuevos = parsePointsCSV(resto.data(), corte + 1);
+                    pendientes.insert(pendientes.end(), nuevos.begin(), nuevos.end());
+                    resto.erase(0, corte + 1);
+                }
+                entregar(false);
+                sin_datos_desde = omp_get_wtime();
+                continue;
+            }
+            entregar(true);
+            if (leidos < 0 || !es_archivo || omp_get_wtime() - sin_datos_desde >= espera) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (!resto.empty()) {
+            const std::vector<Point> nuevos = parsePointsCSV(resto.data(), resto.size());
+            pendientes.insert(pendientes.end(), nuevos.begin(), nuevos.end());
+            entregar(true);
+        }
+    }
+
+#ifdef DBSCAN_MPI
+    // --mpi: cada rango corre `motor` con num_threads hilos sobre su franja. Con
+    // `verificar` el rango 0 carga la entrada completa, corre dbscan_serial y
+    // assignClusters y compara etiquetas y clusters contra el archivo escrito.
+    int runDistributed(int argc, char **argv) {
+        int nivel = 0;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &nivel);
+        int rango = 0;
+        int rangos = 1;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rango);
+        MPI_Comm_size(MPI_COMM_WORLD, &rangos);
+
+        Engine engine = Engine::Grid;
+        if (argc < 3 || (argc > 6 && !parseEngine(argv[6], engine))) {
+            if (rango == 0) {
+                std::cout << "Uso: mpirun -np <rangos> dbscan --mpi <entrada.csv|.bin> [eps] [min_samples] "
+                             "[hilos_por_rango] [motor] [directorio_salida] [verificar]\n";
+            }
+            MPI_Finalize();
+            return 1;
+        }
+        const std::string ruta = argv[2];
+        const double epsilon = argc > 3 ? std::stod(argv[3]) : 0.03;
+        const int min_samples = argc > 4 ? std::stoi(argv[4]) : 10;
+        const int num_threads = argc > 5 ? std::stoi(argv[5]) : 0;
+        const std::string output_dir = argc > 7 ? argv[7] : "data/output";
+        const bool verificar = argc > 8 && std::string(argv[8]) == "verificar";
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        const double inicio = MPI_Wtime();
+        const DistributedResult resultado =
+            dbscan_distributed(ruta, epsilon, min_samples, engine, num_threads, 512, MPI_COMM_WORLD);
+        const double tiempo = MPI_Wtime() - inicio;
+        if (resultado.total == 0) {
+            if (rango == 0) {
+                std::cout << "No se pudieron cargar puntos desde " << ruta << ".\n";
+            }
+            MPI_Finalize();
+            return 1;
+        }
+
+        if (rango == 0) {
+            fs::create_directories(output_dir);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
         const std::string salida =
-            writeResultsCSV(ultimo, output_dir, "parallel_divided");
-        std::cout << "  -> paralelo2 guardó: " << salida << '\n';
+            output_dir + "/" + std::to_string(resultado.total) + "_results_mpi.bin";
+        const bool escrito = writeDistributedResults(resultado, salida, MPI_COMM_WORLD);
+
+        // Propios, halo y fases de cada rango, para ver el balance entre franjas.
+        const double fila[] = {static_cast<double>(resultado.propios), static_cast<double>(resultado.halo),
+                               static_cast<double>(resultado.promovidos), resultado.lectura, resultado.reparto,
+                               resultado.local, resultado.reconciliacion};
+        constexpr int columnas = static_cast<int>(sizeof(fila) / sizeof(fila[0]));
+        std::vector<double> filas(rango == 0 ? static_cast<std::size_t>(columnas * rangos) : 0);
+        MPI_Gather(fila, columnas, MPI_DOUBLE, filas.data(), columnas, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+        int codigo = escrito ? 0 : 1;
+        if (rango == 0) {
+            std::cout << "Rangos: " << rangos << "  puntos: " << resultado.total << "  motor: " << engineName(engine)
+                      << "  hilos por rango: " << (num_threads > 0 ? num_threads : omp_get_max_threads()) << '\n';
+            std::cout << std::fixed << std::setprecision(6);
+            for (int q = 0; q < rangos; ++q) {
+                const double *f = &filas[static_cast<std::size_t>(q * columnas)];
+                std::cout << "  rango " << q << ": propios " << static_cast<std::size_t>(f[0])
+                          << "  halo " << static_cast<std::size_t>(f[1])
+                          << "  cores de halo reconciliados " << static_cast<std::size_t>(f[2])
+                          << "  lectura " << f[3] << "  reparto " << f[4] << "  local " << f[5]
+                          << "  reconciliación " << f[6] << '\n';
+            }
+            std::cout << "Tiempo: " << tiempo << " s\n";
+            if (!escrito) {
+                std::cout << "No se pudo escribir " << salida << ".\n";
+            } else {
+                std::cout << "  -> mpi guardó: " << salida << '\n';
+            }
 
-        const std::size_t mismatches = countMismatches(referencia_serial, ultimo);
-        if (mismatches != 0) {
-            std::cout << "  (!) " << mismatches
-                      << " etiquetas difieren entre serial y paralelo2.\n";
+            if (verificar && escrito) {
+                std::vector<Point> referencia = loadPoints(ruta);
+                Workspace ws;
+                dbscan_serial(referencia, epsilon, min_samples, ws);
+                assignClusters(referencia, epsilon, num_threads);
+                const MappedPoints mapa(salida);
+                const std::int32_t *labels = mapa.labels();
+                const std::int32_t *clusters = mapa.clusters();
+                std::size_t mismatches = 0;
+                std::size_t cluster_mismatches = 0;
+                if (labels == nullptr || clusters == nullptr || mapa.size() != referencia.size()) {
+                    mismatches = referencia.size();
+                    cluster_mismatches = referencia.size();
+                } else {
+                    for (std::size_t i = 0; i < referencia.size(); ++i) {
+                        mismatches += labels[i] != referencia[i].label;
+                        cluster_mismatches += clusters[i] != referencia[i].cluster;
+                    }
+                }
+                if (mismatches == 0) {
+                    std::cout << "Comparación mpi: etiquetas iguales entre serial y mpi.\n";
+                } else {
+                    std::cout << "Comparación mpi: " << mismatches << " puntos con etiqueta distinta entre serial y mpi.\n";
+                    codigo = 1;
+                }
+                if (cluster_mismatches == 0) {
+                    std::cout << "Comparación mpi: clusters iguales a assignClusters.\n";
+                } else {
+                    std::cout << "Comparación mpi: " << cluster_mismatches << " puntos con cluster distinto de assignClusters.\n";
+                    codigo = 1;
+                }
+            }
         }
+        MPI_Bcast(&codigo, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        MPI_Finalize();
+        return codigo;
+    }
+#endif
 
-        return computeStats(tiempos);
+    template <typename T>
+    int runNdFor(const std::string &ruta, double epsilon, int min_samples, int num_threads,
+                 const NdEngines &motores) {
+        std::vector<T> coords;
+        std::size_t dims = 0;
+        if (!loadCoordinatesCSV(ruta, coords, dims)) {
+            std::cout << "No se pudieron cargar puntos desde " << ruta << ".\n";
+            return 1;
+        }
+        switch (dims) {
+        case 2:
+            return runNd<T, 2>(std::move(coords), dims, epsilon, min_samples, num_threads, motores);
+        case 3:
+            return runNd<T, 3>(std::move(coords), dims, epsilon, min_samples, num_threads, motores);
+        case 4:
+            return runNd<T, 4>(std::move(coords), dims, epsilon, min_samples, num_threads, motores);
+        case 8:
+            return runNd<T, 8>(std::move(coords), dims, epsilon, min_samples, num_threads, motores);
+        default:
+            return runNd<T, DIM_DINAMICA>(std::move(coords), dims, epsilon, min_samples, num_threads, motores);
+        }
     }
 
 }
@@ -142,74 +782,621 @@ int main(int argc, char **argv) {
     if (argc > 1 && std::string(argv[1]) == "--benchmark") {
         const double epsilon = argc > 2 ? std::stod(argv[2]) : 0.03;
         const int min_samples = argc > 3 ? std::stoi(argv[3]) : 10;
-        const int iterations = argc > 4 ? std::stoi(argv[4]) : 10;
+        const int iterations = std::max(1, argc > 4 ? std::stoi(argv[4]) : 10);
         const std::string output_dir = argc > 5 ? argv[5] : "data/output";
         const std::string results_file = argc > 6 ? argv[6] : "data/results/experiments.csv";
-        const std::size_t block_size = argc > 7 ? static_cast<std::size_t>(std::stoul(argv[7])) : 512;
+        TuningProfile perfil;
+        const bool hay_perfil = loadProfile(defaultProfilePath(), perfil);
+        const std::size_t block_size =
+            argc > 7 ? static_cast<std::size_t>(std::stoul(argv[7])) : (hay_perfil ? perfil.block_size : 512);
+        // Entradas separadas por coma: un número n es data/input/<n>_data.csv, otra
+        // cosa se toma como ruta.
+        const std::string lista_entradas =
+            argc > 8 ? argv[8] : "20000,40000,80000,120000,140000,160000,180000,200000";
+        const int warmup = std::max(0, argc > 9 ? std::stoi(argv[9]) : 2);
+        const bool generar = argc > 10 && std::string(argv[10]) == "generar";
 
-        const std::vector<std::size_t> sizes = {20000, 40000, 80000, 120000, 140000, 160000, 180000, 200000};
+        std::vector<std::string> entradas;
+        std::set<std::string> generadas;
+        std::stringstream partes(lista_entradas);
+        for (std::string parte; std::getline(partes, parte, ',');) {
+            if (parte.empty()) {
+                continue;
+            }
+            const bool es_numero = parte.find_first_not_of("0123456789") == std::string::npos;
+            if (!es_numero) {
+                entradas.push_back(parte);
+                continue;
+            }
+            // Con `generar`, los tamaños que no estén en data/input se generan (blobs con
+            // la semilla del notebook) para medir escalas arbitrarias; sin él se omiten,
+            // para no comparar datos distintos de los del notebook sin saberlo.
+            const std::string ruta = "data/input/" + parte + "_data.csv";
+            if (!fs::exists(ruta)) {
+                if (!generar) {
+                    std::cout << "  (!) No existe " << ruta << "; se omite (pasa `generar` para crearlo).\n";
+                    continue;
+                }
+                generadas.insert(ruta);
+                GeneratorOptions opciones;
+                opciones.count = static_cast<std::size_t>(std::stoull(parte));
+                std::cout << "Generando " << ruta << " (" << distributionName(opciones.dist) << ", semilla "
+                          << opciones.seed << ")\n";
+                fs::create_directories(fs::path(ruta).parent_path());
+                generateFile(opciones, ruta);
+            }
+            entradas.push_back(ruta);
+        }
 
         const int virtual_cores = omp_get_max_threads();
-        const std::vector<int> thread_options = {
+        std::vector<int> thread_options = {
             1,
             std::max(1, virtual_cores / 2),
             virtual_cores,
             virtual_cores * 2};
+        // Los hilos del perfil de --autotune también se miden.
+        if (hay_perfil && perfil.num_threads > 0) {
+            thread_options.push_back(perfil.num_threads);
+        }
+        std::sort(thread_options.begin(), thread_options.end());
+        thread_options.erase(std::unique(thread_options.begin(), thread_options.end()), thread_options.end());
 
         if (!results_file.empty()) {
             fs::create_directories(fs::path(results_file).parent_path());
         }
+        const std::string json_file = fs::path(results_file).replace_extension(".json").string();
         std::ofstream csv(results_file);
-        csv << "points,threads,mode,time_avg,time_std\n";
-
-        std::vector<double> tiempos_serial;
-        std::vector<double> tiempos_par_full;
-        std::vector<double> tiempos_par_div;
-
-        for (std::size_t n : sizes) {
-            const std::string ruta = "data/input/" + std::to_string(n) + "_data.csv";
-            std::cout << "\n=== Tamaño: " << n << " puntos ===\n";
-            std::vector<Point> ultimo_serial;
+        csv << benchmarkCSVHeader() << '\n';
+        // Con DBSCAN_PERF el detalle por hilo va a <archivo_resultados>_threads.csv.
+        const bool con_perf = perfRequested();
+        fs::path ruta_hilos = results_file;
+        ruta_hilos.replace_filename(ruta_hilos.stem().string() + "_threads.csv");
+        std::ofstream csv_hilos;
+        if (con_perf) {
+            csv_hilos.open(ruta_hilos);
+            csv_hilos << "points,threads,mode,phase,thread,busy,idle";
+            for (int e = 0; e < PERF_EVENTOS; ++e) {
+                csv_hilos << ',' << perfEventName(e);
+            }
+            csv_hilos << '\n';
+        }
 
-            const Stats stats_serial = runSerial(
-                ruta, epsilon, min_samples, iterations,
-                tiempos_serial, output_dir, ultimo_serial);
+        const std::vector<Engine> engines = {
+            Engine::ParallelFull, Engine::ParallelDivided, Engine::ParallelTasks, Engine::Grid, Engine::KdTree};
+        std::vector<BenchRow> filas;
 
-            if (ultimo_serial.empty()) {
+        for (const std::string &ruta : entradas) {
+            const bool generada = generadas.count(ruta) > 0;
+            std::cout << "\n=== Entrada: " << ruta << (generada ? " (generada, blobs)" : "") << " ===\n";
+            const double inicio_carga = omp_get_wtime();
+            const std::vector<Point> puntos = loadPoints(ruta);
+            const double carga = omp_get_wtime() - inicio_carga;
+            if (puntos.empty()) {
                 std::cout << "  (!) No se pudieron cargar puntos para " << ruta
-                          << ". Se omite este tamaño.\n";
+                          << ". Se omite esta entrada.\n";
                 continue;
             }
 
-            csv << n << ",1,serial,"
-                << stats_serial.mean << ',' << stats_serial.stdev << '\n';
-            csv.flush();
+            std::vector<Point> ultimo_serial;
+            filas.push_back({ruta, puntos.size(), 1, "serial", carga,
+                             runEngine(Engine::Serial, ruta, puntos, epsilon, min_samples, 0,
+                                       warmup, iterations, block_size, output_dir, ultimo_serial, nullptr),
+                             generada});
+            writeBenchmarkCSVRow(csv, filas.back());
+            if (con_perf) {
+                writeThreadCSVRows(csv_hilos, filas.back());
+            }
 
             for (int threads : thread_options) {
                 std::cout << "  Hilos: " << threads << '\n';
-                std::vector<Point> ultimo_par_full;
-                const Stats stats_par_full = runParallelFull(
-                    ruta, epsilon, min_samples, threads,
-                    iterations, tiempos_par_full, output_dir,
-                    ultimo_par_full, ultimo_serial);
+                for (Engine engine : engines) {
+                    std::vector<Point> ultimo;
+                    filas.push_back({ruta, puntos.size(), threads, engineName(engine), carga,
+                                     runEngine(engine, ruta, puntos, epsilon, min_samples, threads,
+                                               warmup, iterations, block_size, output_dir, ultimo, &ultimo_serial),
+                                     generada});
+                    writeBenchmarkCSVRow(csv, filas.back());
+                    if (con_perf) {
+                        writeThreadCSVRows(csv_hilos, filas.back());
+                    }
+
+                    const Medicion &m = filas.back().medicion;
+                    std::cout << std::fixed << std::setprecision(6) << "     " << std::left << std::setw(11)
+                              << displayName(engine) << std::right << " mediana " << m.total.median
+                              << " s  (p10 " << m.total.p10 << ", p90 " << m.total.p90 << ")"
+                              << "  conteo " << m.fases.conteo << "  frontera " << m.fases.frontera;
+                    if (pairsPerSecond(m.fases) > 0.0) {
+                        std::cout << std::setprecision(2) << "  " << pairsPerSecond(m.fases) / 1e9
+                                  << " Gpares/s  " << gigabytesPerSecond(m.fases) << " GB/s";
+                    }
+                    if (m.perf.conteo.total().ipc() >= 0.0) {
+                        std::cout << std::setprecision(2) << "  IPC " << m.perf.conteo.total().ipc();
+                    }
+                    if (m.perf.conteo.idleFraction() >= 0.0) {
+                        std::cout << std::setprecision(1) << "  ocioso " << 100.0 * m.perf.conteo.idleFraction() << "%";
+                    }
+                    std::cout << '\n';
+                }
+            }
+        }
+
+        if (!writeBenchmarkJSON(json_file, epsilon, min_samples, warmup, iterations, block_size, filas)) {
+            std::cout << "No se pudo escribir " << json_file << ".\n";
+            return 1;
+        }
+        std::cout << "\nResultados guardados en: " << results_file << " y " << json_file << '\n';
+        if (con_perf) {
+            std::cout << "Contadores por hilo en: " << ruta_hilos.string() << '\n';
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--mpi") {
+#ifdef DBSCAN_MPI
+        return runDistributed(argc, argv);
+#else
+        std::cout << "Este binario se compiló sin MPI; compila con mpicxx -DDBSCAN_MPI (ver README).\n";
+        return 1;
+#endif
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--ooc") {
+        OutOfCoreOptions opciones;
+        if (argc < 3 || (argc > 7 && !parseEngine(argv[7], opciones.engine))) {
+            std::cout << "Uso: dbscan --ooc <entrada.csv|.bin> [eps] [min_samples] [memoria_mb] [hilos] [motor] "
+                         "[directorio_salida] [verificar]\n";
+            return 1;
+        }
+        const std::string ruta = argv[2];
+        const double epsilon = argc > 3 ? std::stod(argv[3]) : 0.03;
+        const int min_samples = argc > 4 ? std::stoi(argv[4]) : 10;
+        opciones.memoria = (argc > 5 ? static_cast<std::size_t>(std::stoull(argv[5])) : 1024) << 20;
+        opciones.num_threads = argc > 6 ? std::stoi(argv[6]) : 0;
+        const std::string output_dir = argc > 8 ? argv[8] : "data/output";
+        const bool verificar = argc > 9 && std::string(argv[9]) == "verificar";
+        if (opciones.num_threads > 0) {
+            omp_set_num_threads(opciones.num_threads);
+        }
+
+        fs::create_directories(output_dir);
+        // n se conoce después del escaneo: se escribe con nombre provisional y se renombra
+        // a <n>_results_ooc.bin como las demás salidas.
+        const std::string provisional = output_dir + "/" + fs::path(ruta).stem().string() + "_results_ooc.tmp.bin";
+        const double inicio = omp_get_wtime();
+        const OutOfCoreResult r = dbscan_out_of_core(ruta, provisional, epsilon, min_samples, opciones);
+        const double tiempo = omp_get_wtime() - inicio;
+        if (!r.ok) {
+            std::error_code error;
+            fs::remove(provisional, error);
+            std::cerr << "Error: " << r.error << std::endl;
+            std::cout << "No se pudo completar la ejecución fuera de memoria para " << ruta << ".\n";
+            return 1;
+        }
+        const std::string salida = output_dir + "/" + std::to_string(r.total) + "_results_ooc.bin";
+        fs::rename(provisional, salida);
+        std::cout << std::fixed << std::setprecision(6)
+                  << "Puntos: " << r.total << "  particiones: " << r.particiones
+                  << "  mayor partición: " << r.mayor << " puntos (~"
+                  << r.mayor * OOC_BYTES_POR_PUNTO / (std::size_t{1} << 20) << " MB de "
+                  << (opciones.memoria >> 20) << " MB)\n"
+                  << "Halo: " << r.halo << " copias  cores de halo reconciliados: " << r.promovidos << '\n'
+                  << "Escaneo: " << r.escaneo << " s  reparto: " << r.reparto << " s  local: " << r.local
+                  << " s  reconciliación: " << r.reconciliacion << " s\n"
+                  << "Tiempo: " << tiempo << " s\n"
+                  << "  -> ooc guardó: " << salida << '\n';
+
+        if (verificar) {
+            std::vector<Point> referencia = loadPoints(ruta);
+            Workspace ws;
+            dbscan_serial(referencia, epsilon, min_samples, ws);
+            const MappedPoints mapa(salida);
+            const std::int32_t *labels = mapa.labels();
+            std::size_t mismatches = 0;
+            if (labels == nullptr || mapa.size() != referencia.size()) {
+                mismatches = referencia.size();
+            } else {
+                for (std::size_t i = 0; i < referencia.size(); ++i) {
+                    mismatches += labels[i] != referencia[i].label;
+                }
+            }
+            if (mismatches != 0) {
+                std::cout << "Comparación ooc: " << mismatches << " puntos con etiqueta distinta entre serial y ooc.\n";
+                return 1;
+            }
+            std::cout << "Comparación ooc: etiquetas iguales entre serial y ooc.\n";
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        ServerOptions opciones;
+        if (argc < 3 || (argc > 5 && !parseEngine(argv[5], opciones.engine)) ||
+            (argc > 6 && !parseCurve(argv[6], opciones.curva))) {
+            std::cout << "Uso: dbscan --serve <socket> [memoria_mb] [hilos] [motor] [curva]\n";
+            return 1;
+        }
+        opciones.socket = argv[2];
+        opciones.memoria = (argc > 3 ? static_cast<std::size_t>(std::stoull(argv[3])) : 4096) << 20;
+        opciones.num_threads = argc > 4 ? std::stoi(argv[4]) : 0;
+        if (opciones.num_threads > 0) {
+            omp_set_num_threads(opciones.num_threads);
+        }
+        pinThreads(affinityRequested(), opciones.num_threads);
 
-                csv << n << ',' << threads << ",parallel_full,"
-                    << stats_par_full.mean << ',' << stats_par_full.stdev << '\n';
-                csv.flush();
+        DBSCANServer servidor(opciones);
+        std::cout << "Escuchando en " << opciones.socket << "  cache: " << (opciones.memoria >> 20)
+                  << " MB  motor: " << engineName(opciones.engine) << "  curva: " << curveName(opciones.curva)
+                  << '\n' << std::flush;
+        return servidor.serve(std::cout) ? 0 : 1;
+    }
 
-                std::vector<Point> ultimo_par_div;
-                const Stats stats_par_div = runParallelDivided(
-                    ruta, epsilon, min_samples, threads,
-                    iterations, block_size, tiempos_par_div,
-                    output_dir, ultimo_par_div, ultimo_serial);
+    if (argc > 1 && std::string(argv[1]) == "--client") {
+        if (argc < 3) {
+            std::cout << "Uso: dbscan --client <socket> [solicitud...]   (sin solicitud, una por línea en stdin)\n";
+            return 1;
+        }
+        std::vector<std::string> lineas;
+        if (argc > 3) {
+            std::string linea = argv[3];
+            for (int k = 4; k < argc; ++k) {
+                linea += ' ';
+                linea += argv[k];
+            }
+            lineas.push_back(linea);
+        } else {
+            for (std::string linea; std::getline(std::cin, linea);) {
+                lineas.push_back(linea);
+            }
+        }
+        std::vector<std::string> respuestas;
+        if (!sendRequests(argv[2], lineas, respuestas)) {
+            std::cout << "No se pudo conectar a " << argv[2] << ".\n";
+            return 1;
+        }
+        bool ok = true;
+        for (const auto &respuesta : respuestas) {
+            std::cout << respuesta << '\n';
+            ok = ok && respuesta.rfind("ok", 0) == 0;
+        }
+        return ok ? 0 : 1;
+    }
 
-                csv << n << ',' << threads << ",parallel_divided,"
-                    << stats_par_div.mean << ',' << stats_par_div.stdev << '\n';
-                csv.flush();
+    if (argc > 1 && std::string(argv[1]) == "--sweep") {
+        if (argc < 5) {
+            std::cout << "Uso: dbscan --sweep <entrada.csv|.bin> <eps1,eps2,...> <min1,min2,...> [hilos] "
+                         "[directorio_salida] [etiquetas]\n";
+            return 1;
+        }
+        const std::string ruta = argv[2];
+        std::vector<double> epsilons = parseNumberList(argv[3]);
+        std::vector<int> mins;
+        for (double m : parseNumberList(argv[4])) {
+            mins.push_back(static_cast<int>(m));
+        }
+        const int num_threads = argc > 5 ? std::stoi(argv[5]) : 0;
+        const std::string output_dir = argc > 6 ? argv[6] : "data/output";
+        const bool con_etiquetas = argc > 7 && std::string(argv[7]) == "etiquetas";
+        if (epsilons.empty() || mins.empty()) {
+            std::cout << "Las listas de eps y min_samples no pueden estar vacías.\n";
+            return 1;
+        }
+        if (num_threads > 0) {
+            omp_set_num_threads(num_threads);
+        }
+
+        std::vector<Point> puntos = loadPoints(ruta);
+        if (puntos.empty()) {
+            std::cout << "No se pudieron cargar puntos desde " << ruta << ".\n";
+            return 1;
+        }
+        const double inicio = omp_get_wtime();
+        NeighborProfile perfil;
+        buildNeighborProfile(puntos, *std::max_element(epsilons.begin(), epsilons.end()), perfil);
+        const double tiempo_perfil = omp_get_wtime() - inicio;
+        std::vector<std::int8_t> etiquetas;
+        const std::vector<SweepResult> resultados =
+            sweepLabels(perfil, epsilons, mins, con_etiquetas ? &etiquetas : nullptr);
+        const double tiempo_barrido = omp_get_wtime() - inicio - tiempo_perfil;
+
+        std::cout << std::fixed << std::setprecision(6)
+                  << "Puntos: " << puntos.size() << "  eps_max: " << perfil.eps_max
+                  << "  pares vecinos: " << perfil.pairs() << " (~"
+                  << perfil.pairs() * (sizeof(double) + sizeof(int)) / (std::size_t{1} << 20) << " MB)\n"
+                  << "Perfil: " << tiempo_perfil << " s  barrido de " << resultados.size()
+                  << " configuraciones: " << tiempo_barrido << " s\n";
+
+        fs::create_directories(output_dir);
+        const std::string resumen = output_dir + "/" + std::to_string(puntos.size()) + "_sweep.csv";
+        std::ofstream archivo(resumen);
+        archivo << "epsilon,min_samples,cores,frontera,ruido,segundos\n";
+        archivo << std::setprecision(9);
+        for (std::size_t k = 0; k < resultados.size(); ++k) {
+            const SweepResult &r = resultados[k];
+            std::cout << "  eps " << r.epsilon << "  min " << r.min_samples << ": cores " << r.cores
+                      << "  frontera " << r.frontera << "  ruido " << r.ruido << "  (" << r.tiempo << " s)\n";
+            archivo << r.epsilon << ',' << r.min_samples << ',' << r.cores << ',' << r.frontera << ','
+                    << r.ruido << ',' << r.tiempo << '\n';
+            if (con_etiquetas) {
+                for (std::size_t i = 0; i < puntos.size(); ++i) {
+                    puntos[i].label = etiquetas[k * puntos.size() + i];
+                }
+                std::ostringstream nombre;
+                nombre << "sweep_e" << r.epsilon << "_m" << r.min_samples;
+                assignClusters(puntos, r.epsilon);
+                std::cout << "    -> guardó: " << writeResultsFor(ruta, puntos, output_dir, nombre.str()) << '\n';
             }
         }
+        std::cout << "  -> resumen guardado en: " << resumen << '\n';
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--approx") {
+        // La referencia exacta es opcional: en millones de puntos el serial es lo lento
+        // y una vista previa puede compararse contra grid o no compararse.
+        const std::string referencia_nombre = argc > 9 ? argv[9] : "serial";
+        Engine referencia_engine = Engine::Serial;
+        const bool con_referencia = referencia_nombre != "ninguna";
+        if (argc < 3 || (con_referencia && !parseEngine(referencia_nombre, referencia_engine))) {
+            std::cout << "Uso: dbscan --approx <entrada.csv|.bin> [eps] [min_samples] [rho] [hilos] [muestra] "
+                         "[directorio_salida] [referencia|ninguna]\n";
+            return 1;
+        }
+        const std::string ruta = argv[2];
+        const double epsilon = argc > 3 ? std::stod(argv[3]) : 0.03;
+        const int min_samples = argc > 4 ? std::stoi(argv[4]) : 10;
+        ApproxOptions opciones;
+        opciones.rho = argc > 5 ? std::stod(argv[5]) : opciones.rho;
+        const int num_threads = argc > 6 ? std::stoi(argv[6]) : 0;
+        opciones.muestra = argc > 7 ? static_cast<std::size_t>(std::stoull(argv[7])) : opciones.muestra;
+        const std::string output_dir = argc > 8 ? argv[8] : "data/output";
+
+        std::vector<Point> puntos = loadPoints(ruta);
+        if (puntos.empty()) {
+            std::cout << "No se pudieron cargar puntos desde " << ruta << ".\n";
+            return 1;
+        }
+        Workspace ws;
+        const double inicio = omp_get_wtime();
+        dbscan_approx(puntos, epsilon, min_samples, opciones, num_threads, ws);
+        const double tiempo = omp_get_wtime() - inicio;
+        std::cout << std::fixed << std::setprecision(6)
+                  << "Puntos: " << puntos.size() << "  rho: " << opciones.rho << "  muestra: " << opciones.muestra
+                  << '\n'
+                  << "Aproximado: " << tiempo << " s  (distancias medidas: "
+                  << static_cast<std::uint64_t>(ws.fases.pares) << ")\n";
+        fs::create_directories(output_dir);
+        assignClusters(puntos, epsilon, num_threads);
+        std::cout << "  -> approx guardó: " << writeResultsFor(ruta, puntos, output_dir, "approx") << '\n';
 
-        std::cout << "\nResultados guardados en: " << results_file << '\n';
+        if (con_referencia) {
+            std::vector<Point> exactos = loadPoints(ruta);
+            Clusterer clusterer(referencia_engine, num_threads);
+            const double inicio_exacto = omp_get_wtime();
+            clusterer.run(exactos, epsilon, min_samples);
+            const double tiempo_exacto = omp_get_wtime() - inicio_exacto;
+            const std::size_t mismatches = countMismatches(exactos, puntos);
+            std::cout << displayName(referencia_engine) << ": " << tiempo_exacto << " s  aceleración: "
+                      << (tiempo > 0.0 ? tiempo_exacto / tiempo : 0.0) << "x\n"
+                      << "Comparación approx: " << mismatches << " de " << puntos.size()
+                      << " puntos con etiqueta distinta (" << std::setprecision(3)
+                      << 100.0 * static_cast<double>(mismatches) / static_cast<double>(puntos.size()) << " %).\n";
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--verify") {
+        VerifyOptions opciones;
+        if (argc > 2) {
+            opciones.count = static_cast<std::size_t>(std::stoul(argv[2]));
+        }
+        if (argc > 3 && std::string(argv[3]) != "auto") {
+            for (double h : parseNumberList(argv[3])) {
+                opciones.hilos.push_back(std::max(1, static_cast<int>(h)));
+            }
+        }
+        opciones.base = argc > 4 ? argv[4] : defaultBaselinePath();
+        if (opciones.base == "ninguna") {
+            opciones.base.clear();
+        }
+        if (argc > 5) {
+            opciones.umbral = std::stod(argv[5]);
+        }
+        // La base solo se escribe a pedido: sin ella la corrida falla en lugar de crearla.
+        opciones.actualizar = argc > 6 && (std::string(argv[6]) == "actualizar" || std::string(argv[6]) == "--actualizar");
+
+        std::cout << "CPU: " << cpuModel() << "  núcleos SIMD: " << simdKernelName() << '\n';
+        const VerifyReport reporte = verifyEngines(opciones, std::cout);
+        return reporte.ok() ? 0 : 1;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--autotune") {
+        if (argc < 3) {
+            std::cout << "Uso: dbscan --autotune <entrada.csv|.bin> [eps] [min_samples] [muestra] [perfil]\n";
+            return 1;
+        }
+        const std::string ruta = argv[2];
+        const double epsilon = argc > 3 ? std::stod(argv[3]) : 0.03;
+        const int min_samples = argc > 4 ? std::stoi(argv[4]) : 10;
+        const std::size_t muestra = argc > 5 ? static_cast<std::size_t>(std::stoul(argv[5])) : 20000;
+        const std::string ruta_perfil = argc > 6 ? argv[6] : defaultProfilePath();
+
+        const std::vector<Point> puntos = loadPoints(ruta);
+        if (puntos.empty()) {
+            std::cout << "No se pudieron cargar puntos desde " << ruta << ".\n";
+            return 1;
+        }
+        std::cout << "CPU: " << cpuModel() << "  núcleos SIMD: " << simdKernelName() << '\n';
+        const TuningProfile perfil = autotune(puntos, epsilon, min_samples, muestra, std::cout);
+        std::cout << "\nMejor: " << engineName(perfil.engine) << "  hilos " << perfil.num_threads
+                  << "  bloque " << perfil.block_size << '\n';
+        if (!saveProfile(ruta_perfil, perfil)) {
+            std::cout << "No se pudo escribir " << ruta_perfil << ".\n";
+            return 1;
+        }
+        std::cout << "  -> perfil guardado en: " << ruta_perfil << '\n';
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--generate") {
+        Distribution dist;
+        if (argc < 5 || !parseDistribution(argv[2], dist)) {
+            std::cout << "Uso: dbscan --generate <uniform|blobs|skewed|noise> <n> <salida.csv|.bin> [semilla] [centros]\n";
+            return 1;
+        }
+        GeneratorOptions opciones;
+        opciones.dist = dist;
+        opciones.count = static_cast<std::size_t>(std::stoull(argv[3]));
+        const std::string salida = argv[4];
+        if (argc > 5) {
+            opciones.seed = std::stoull(argv[5]);
+        }
+        if (argc > 6) {
+            opciones.centros = std::max(1, std::stoi(argv[6]));
+        }
+
+        const fs::path padre = fs::path(salida).parent_path();
+        if (!padre.empty()) {
+            fs::create_directories(padre);
+        }
+        const double inicio = omp_get_wtime();
+        if (!generateFile(opciones, salida)) {
+            return 1;
+        }
+        std::cout << "Generados " << opciones.count << " puntos (" << distributionName(opciones.dist) << ", semilla "
+                  << opciones.seed << ", " << opciones.centros << " centros) en " << std::fixed << std::setprecision(3)
+                  << omp_get_wtime() - inicio << " s -> " << salida << '\n';
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--convert") {
+        if (argc < 4) {
+            std::cout << "Uso: dbscan --convert <entrada.csv|.bin> <salida.csv|.bin>\n";
+            return 1;
+        }
+        const std::string entrada = argv[2];
+        const std::string salida = argv[3];
+        const std::vector<Point> puntos = loadPoints(entrada);
+        if (puntos.empty()) {
+            std::cout << "No se pudieron cargar puntos desde " << entrada << ".\n";
+            return 1;
+        }
+        bool ok = true;
+        if (isBinaryPath(salida)) {
+            ok = writePointsBinary(puntos, salida, false);
+        } else {
+            std::ofstream out(salida);
+            out.precision(17);
+            for (const auto &p : puntos) {
+                out << p.x << ',' << p.y << '\n';
+            }
+            ok = static_cast<bool>(out);
+        }
+        if (!ok) {
+            std::cout << "No se pudo escribir " << salida << ".\n";
+            return 1;
+        }
+        std::cout << puntos.size() << " puntos convertidos a " << salida << '\n';
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--nd") {
+        if (argc < 3) {
+            std::cout << "Uso: dbscan --nd <entrada.csv> [eps] [min_samples] [hilos] [float|double] [motores|todos]\n";
+            return 1;
+        }
+        const std::string ruta = argv[2];
+        const double epsilon = argc > 3 ? std::stod(argv[3]) : 0.03;
+        const int min_samples = argc > 4 ? std::stoi(argv[4]) : 10;
+        const int num_threads = argc > 5 ? std::stoi(argv[5]) : 0;
+        const std::string escalar = argc > 6 ? argv[6] : "double";
+        NdEngines motores;
+        if (argc > 7 && !parseNdEngines(argv[7], motores)) {
+            std::cout << "Motores desconocidos: " << argv[7]
+                      << " (serial,parallel_full,parallel_divided,kdtree|todos)\n";
+            return 1;
+        }
+        if (escalar == "float") {
+            return runNdFor<float>(ruta, epsilon, min_samples, num_threads, motores);
+        }
+        if (escalar != "double") {
+            std::cout << "Escalar desconocido: " << escalar << " (float|double)\n";
+            return 1;
+        }
+        return runNdFor<double>(ruta, epsilon, min_samples, num_threads, motores);
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--stream") {
+        if (argc < 3) {
+            std::cout << "Uso: dbscan --stream <entrada.csv|-> [eps] [min_samples] [ventana] [lote] [espera_s] [directorio_salida]\n";
+            return 1;
+        }
+        const std::string ruta = argv[2];
+        const double epsilon = argc > 3 ? std::stod(argv[3]) : 0.03;
+        const int min_samples = argc > 4 ? std::stoi(argv[4]) : 10;
+        const std::size_t ventana = argc > 5 ? static_cast<std::size_t>(std::stoul(argv[5])) : 0;
+        const std::size_t lote = std::max<std::size_t>(1, argc > 6 ? static_cast<std::size_t>(std::stoul(argv[6])) : 1000);
+        const double espera = argc > 7 ? std::stod(argv[7]) : 0.0;
+        const std::string output_dir = argc > 8 ? argv[8] : "data/output";
+
+        const bool es_archivo = ruta != "-";
+        const int fd = es_archivo ? ::open(ruta.c_str(), O_RDONLY) : STDIN_FILENO;
+        if (fd < 0) {
+            std::cout << "No se pudo abrir " << ruta << ".\n";
+            return 1;
+        }
+
+        StreamingDBSCAN stream(epsilon, min_samples, ventana);
+        std::size_t numero = 0;
+        readBatches(fd, es_archivo, lote, espera, [&](const std::vector<Point> &puntos) {
+            const double inicio = omp_get_wtime();
+            const StreamingDBSCAN::Cambios cambios = stream.insert(puntos);
+            const double tiempo = omp_get_wtime() - inicio;
+            std::cout << std::fixed << std::setprecision(6)
+                      << "Lote " << ++numero << ": +" << cambios.insertados << " -" << cambios.expirados
+                      << "  activos: " << stream.size() << "  cores: " << stream.cores()
+                      << "  ruido: " << stream.noise() << "  reetiquetados: " << cambios.reetiquetados
+                      << "  tiempo: " << tiempo << " s\n";
+        });
+        if (es_archivo) {
+            ::close(fd);
+        }
+        if (stream.size() == 0) {
+            std::cout << "No se recibieron puntos.\n";
+            return 1;
+        }
+        std::vector<Point> activos = stream.snapshot();
+        assignClusters(activos, epsilon);
+        const std::string salida = writeResultsCSV(activos, output_dir, "stream");
+        std::cout << "  -> stream guardó: " << salida << '\n';
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--clusters") {
+        const std::string ruta = argc > 2 ? argv[2] : "data/input/4000_data.csv";
+        const double epsilon = argc > 3 ? std::stod(argv[3]) : 0.03;
+        const int min_samples = argc > 4 ? std::stoi(argv[4]) : 10;
+        const int num_threads = argc > 5 ? std::stoi(argv[5]) : 0;
+        const std::string output_dir = argc > 6 ? argv[6] : "data/output";
+
+        const double inicio = omp_get_wtime();
+        const std::vector<Point> puntos = dbscan_clusters(ruta, epsilon, min_samples, num_threads);
+        const double tiempo = omp_get_wtime() - inicio;
+        if (puntos.empty()) {
+            std::cout << "No se pudieron cargar puntos desde " << ruta << ".\n";
+            return 1;
+        }
+
+        int clusters = 0;
+        std::size_t ruido = 0;
+        for (const auto &p : puntos) {
+            clusters = std::max(clusters, p.cluster + 1);
+            ruido += p.cluster == NOISE;
+        }
+        const std::string salida = writeResultsFor(ruta, puntos, output_dir, "clusters");
+        std::cout << std::fixed << std::setprecision(6)
+                  << "Clusters: " << clusters << "  ruido: " << ruido
+                  << "  tiempo: " << tiempo << " s\n"
+                  << "  -> clusters guardó: " << salida << '\n';
         return 0;
     }
 
@@ -219,65 +1406,117 @@ int main(int argc, char **argv) {
         argc > 2 ? std::stod(argv[2]) : 0.03;
     const int min_samples =
         argc > 3 ? std::stoi(argv[3]) : 10;
+    // Sin hilos o bloque explícitos se usan los del perfil de --autotune, si existe.
+    TuningProfile perfil;
+    const bool hay_perfil = loadProfile(defaultProfilePath(), perfil);
     const int num_threads =
-        argc > 4 ? std::stoi(argv[4]) : 0;
+        argc > 4 ? std::stoi(argv[4]) : (hay_perfil ? perfil.num_threads : 0);
     const std::string output_dir =
         argc > 5 ? argv[5] : "data/output";
     const std::size_t block_size =
-        argc > 6 ? static_cast<std::size_t>(std::stoul(argv[6])) : 512;
+        argc > 6 ? static_cast<std::size_t>(std::stoul(argv[6])) : (hay_perfil ? perfil.block_size : 512);
 
     std::cout << "Ruta: " << ruta << '\n'
               << "epsilon: " << epsilon << "  min_samples: " << min_samples
               << "  threads paralelo: " << (num_threads > 0 ? num_threads : omp_get_max_threads())
-              << "\n\n";
+              << "  núcleos SIMD: " << simdKernelName() << "  curva: " << curveName(curveRequested()) << '\n'
+              << "Nodos NUMA: " << numaTopology().nodes() << "  afinidad: " << affinityName(affinityRequested())
+              << '\n';
+    if (hay_perfil) {
+        std::cout << "Perfil " << defaultProfilePath() << ": " << engineName(perfil.engine)
+                  << "  hilos " << perfil.num_threads << "  bloque " << perfil.block_size << '\n';
+    }
 
-    std::vector<double> tiempos_serial;
-    std::vector<Point> resultado_serial;
-    const Stats stats_serial = runSerial(ruta, epsilon, min_samples, 1, tiempos_serial, output_dir, resultado_serial);
-    if (resultado_serial.empty()) {
+    // Motores que se comparan contra el serial: los de argv[7] ("todos" o una lista
+    // separada por comas); sin lista, solo el del perfil si existe y si no todos.
+    const std::vector<Engine> todos = {
+        Engine::ParallelFull, Engine::ParallelDivided, Engine::ParallelTasks, Engine::Grid, Engine::KdTree};
+    std::vector<Clusterer> clusterers;
+    if (argc > 7 && std::string(argv[7]) != "todos") {
+        std::stringstream partes(argv[7]);
+        for (std::string parte; std::getline(partes, parte, ',');) {
+            Engine engine;
+            if (!parseEngine(parte, engine)) {
+                std::cout << "Motor desconocido: " << parte << '\n';
+                return 1;
+            }
+            if (engine != Engine::Serial) {
+                clusterers.emplace_back(engine, num_threads, block_size);
+            }
+        }
+    } else if (argc <= 7 && hay_perfil) {
+        // Los hilos y el bloque explícitos reemplazan a los del perfil.
+        clusterers.push_back(makeClusterer(perfil));
+        clusterers.back().setThreads(num_threads);
+        clusterers.back().setBlockSize(block_size);
+        if (perfil.engine == Engine::Serial) {
+            clusterers.clear();
+        }
+    } else {
+        for (Engine engine : todos) {
+            clusterers.emplace_back(engine, num_threads, block_size);
+        }
+    }
+    std::cout << '\n';
+
+    const double inicio_carga = omp_get_wtime();
+    const std::vector<Point> puntos = loadPoints(ruta);
+    const double tiempo_carga = omp_get_wtime() - inicio_carga;
+    if (puntos.empty()) {
         std::cout << "No se pudieron cargar puntos desde " << ruta << ".\n";
         return 1;
     }
-    std::vector<double> tiempos_par_full;
-    std::vector<Point> resultado_paralelo;
-    const Stats stats_par_full = runParallelFull(
-        ruta, epsilon, min_samples, num_threads,
-        1, tiempos_par_full, output_dir, resultado_paralelo, resultado_serial);
-    const std::size_t mismatches = countMismatches(resultado_serial, resultado_paralelo);
-
-    std::vector<double> tiempos_par_div;
-    std::vector<Point> resultado_paralelo_div;
-    const Stats stats_par_div = runParallelDivided(
-        ruta, epsilon, min_samples, num_threads,
-        1, block_size, tiempos_par_div, output_dir,
-        resultado_paralelo_div, resultado_serial);
-    const std::size_t mismatches_div = countMismatches(resultado_serial, resultado_paralelo_div);
+
+    std::vector<Point> resultado_serial;
+    const Medicion medicion_serial = runEngine(
+        Engine::Serial, ruta, puntos, epsilon, min_samples, 0,
+        0, 1, block_size, output_dir, resultado_serial, nullptr);
+    const Stats stats_serial = medicion_serial.total;
+
+    std::vector<Engine> engines;
+    std::vector<Stats> stats;
+    std::vector<PerfReport> perf;
+    std::vector<std::size_t> mismatches;
+    for (Clusterer &clusterer : clusterers) {
+        std::vector<Point> resultado;
+        const Medicion medicion = runClusterer(
+            clusterer, ruta, puntos, epsilon, min_samples,
+            0, 1, output_dir, resultado, &resultado_serial);
+        engines.push_back(clusterer.engine());
+        stats.push_back(medicion.total);
+        perf.push_back(medicion.perf);
+        mismatches.push_back(countMismatches(resultado_serial, resultado));
+    }
 
     std::cout << std::fixed << std::setprecision(6);
+    std::cout << "Carga:     " << tiempo_carga << " s\n";
     std::cout << "Serial:    " << stats_serial.mean << " s\n";
-    std::cout << "Paralelo1: " << stats_par_full.mean << " s\n";
-    if (stats_par_full.mean > 0.0) {
-        std::cout << "Speedup:   " << (stats_serial.mean / stats_par_full.mean) << "x\n";
-    }
-    std::cout << "Paralelo2: " << stats_par_div.mean << " s\n";
-    if (stats_par_div.mean > 0.0) {
-        std::cout << "Speedup2:  " << (stats_serial.mean / stats_par_div.mean) << "x\n";
+    for (std::size_t k = 0; k < engines.size(); ++k) {
+        std::cout << std::left << std::setw(11) << (std::string(displayName(engines[k])) + ":")
+                  << std::right << stats[k].mean << " s";
+        if (stats[k].mean > 0.0) {
+            std::cout << "  speedup " << (stats_serial.mean / stats[k].mean) << "x";
+        }
+        std::cout << '\n';
     }
 
-    if (mismatches == 0) {
-        std::cout << "Comparación P1: etiquetas iguales entre serial y paralelo2.\n";
-    }
-    else {
-        std::cout << "Comparación: " << mismatches
-                  << " puntos con etiqueta distinta entre serial y paralelo.\n";
+    for (std::size_t k = 0; k < engines.size(); ++k) {
+        if (mismatches[k] == 0) {
+            std::cout << "Comparación " << displayName(engines[k])
+                      << ": etiquetas iguales entre serial y " << displayName(engines[k]) << ".\n";
+        }
+        else {
+            std::cout << "Comparación " << displayName(engines[k]) << ": " << mismatches[k]
+                      << " puntos con etiqueta distinta entre serial y " << displayName(engines[k]) << ".\n";
+        }
     }
 
-    if (mismatches_div == 0) {
-        std::cout << "Comparación P2: etiquetas iguales entre serial y paralelo2.\n";
-    }
-    else {
-        std::cout << "Comparación P2: " << mismatches_div
-                  << " puntos con etiqueta distinta entre serial y paralelo2.\n";
+    if (medicion_serial.perf.activo) {
+        std::cout << '\n';
+        printPerf(std::cout, displayName(Engine::Serial), medicion_serial.perf);
+        for (std::size_t k = 0; k < engines.size(); ++k) {
+            printPerf(std::cout, displayName(engines[k]), perf[k]);
+        }
     }
 
     return 0;
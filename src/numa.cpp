@@ -0,0 +1,218 @@
+#include "numa.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <cstdint>
+#include <sstream>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using std::size_t;
+
+const char* affinityName(Affinity afinidad) {
+    switch (afinidad) {
+    case Affinity::Ninguna:
+        return "ninguna";
+    case Affinity::Compacta:
+        return "compacta";
+    case Affinity::Dispersa:
+        return "dispersa";
+    }
+    return "desconocida";
+}
+
+bool parseAffinity(const std::string& nombre, Affinity& afinidad) {
+    for (Affinity candidata : {Affinity::Ninguna, Affinity::Compacta, Affinity::Dispersa}) {
+        if (nombre == affinityName(candidata)) {
+            afinidad = candidata;
+            return true;
+        }
+    }
+    return false;
+}
+
+Affinity affinityRequested() {
+    const char* valor = std::getenv("DBSCAN_AFFINITY");
+    Affinity afinidad = Affinity::Ninguna;
+    if (valor != nullptr) {
+        parseAffinity(valor, afinidad);
+    }
+    return afinidad;
+}
+
+size_t NumaTopology::cpuCount() const {
+    size_t total = 0;
+    for (const auto& nodo : cpus) {
+        total += nodo.size();
+    }
+    return total;
+}
+
+namespace {
+
+// Interpreta una lista de CPUs del kernel ("0-3,8-11").
+std::vector<int> parseCpuList(const std::string& texto) {
+    std::vector<int> cpus;
+    std::stringstream partes(texto);
+    for (std::string parte; std::getline(partes, parte, ',');) {
+        if (parte.empty() || parte == "\n") {
+            continue;
+        }
+        const size_t guion = parte.find('-');
+        const int desde = std::atoi(parte.c_str());
+        const int hasta = guion == std::string::npos ? desde : std::atoi(parte.c_str() + guion + 1);
+        for (int cpu = desde; cpu <= hasta; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+NumaTopology detectTopology() {
+    NumaTopology topologia;
+#ifdef __linux__
+    cpu_set_t permitidas;
+    CPU_ZERO(&permitidas);
+    const bool con_mascara = ::sched_getaffinity(0, sizeof(permitidas), &permitidas) == 0;
+    auto permitida = [&](int cpu) {
+        return !con_mascara || (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &permitidas));
+    };
+
+    // Los nodos pueden no ser consecutivos (por ejemplo con memoria sin CPUs).
+    for (int nodo = 0; nodo < 1024; ++nodo) {
+        std::ifstream archivo("/sys/devices/system/node/node" + std::to_string(nodo) + "/cpulist");
+        if (!archivo) {
+            continue;
+        }
+        std::string texto;
+        std::getline(archivo, texto);
+        std::vector<int> cpus;
+        for (int cpu : parseCpuList(texto)) {
+            if (permitida(cpu)) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) {
+            topologia.cpus.push_back(std::move(cpus));
+        }
+    }
+    if (topologia.cpus.empty()) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (con_mascara && CPU_ISSET(cpu, &permitidas)) {
+                cpus.push_back(cpu);
+            }
+        }
+        topologia.cpus.push_back(std::move(cpus));
+    }
+#else
+    topologia.cpus.emplace_back();
+#endif
+    return topologia;
+}
+
+}  // namespace
+
+const NumaTopology& numaTopology() {
+    static const NumaTopology topologia = detectTopology();
+    return topologia;
+}
+
+int pinThreads(Affinity afinidad, int num_threads) {
+    const NumaTopology& topologia = numaTopology();
+    if (afinidad == Affinity::Ninguna || topologia.cpuCount() == 0) {
+        return 0;
+    }
+    // Orden en que los hilos toman CPUs: por nodo (compacta) o alternando nodos.
+    std::vector<int> orden;
+    if (afinidad == Affinity::Compacta) {
+        for (const auto& nodo : topologia.cpus) {
+            orden.insert(orden.end(), nodo.begin(), nodo.end());
+        }
+    } else {
+        for (size_t k = 0; orden.size() < topologia.cpuCount(); ++k) {
+            for (const auto& nodo : topologia.cpus) {
+                if (k < nodo.size()) {
+                    orden.push_back(nodo[k]);
+                }
+            }
+        }
+    }
+
+    int fijados = 0;
+#ifdef __linux__
+    const int hilos = num_threads > 0 ? num_threads : omp_get_max_threads();
+#pragma omp parallel num_threads(hilos) reduction(+ : fijados)
+    {
+        const size_t tid = static_cast<size_t>(omp_get_thread_num());
+        cpu_set_t mascara;
+        CPU_ZERO(&mascara);
+        CPU_SET(orden[tid % orden.size()], &mascara);
+        fijados += ::sched_setaffinity(0, sizeof(mascara), &mascara) == 0 ? 1 : 0;
+    }
+#else
+    (void)num_threads;
+#endif
+    return fijados;
+}
+
+int currentNode() {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned nodo = 0;
+    if (::syscall(SYS_getcpu, &cpu, &nodo, nullptr) == 0) {
+        return static_cast<int>(nodo);
+    }
+#endif
+    return 0;
+}
+
+size_t partitionPages(void* datos, size_t bytes) {
+    if (numaTopology().nodes() <= 1 || datos == nullptr || bytes == 0) {
+        return 0;
+    }
+    size_t movidas = 0;
+#if defined(__linux__) && defined(SYS_move_pages)
+    constexpr int MOVER = 1 << 1;  // MPOL_MF_MOVE: solo páginas de este proceso
+    const size_t pagina = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const auto base = reinterpret_cast<std::uintptr_t>(datos);
+    const std::uintptr_t primera = base / pagina * pagina;
+    const size_t paginas = (base + bytes - primera + pagina - 1) / pagina;
+#pragma omp parallel reduction(+ : movidas)
+    {
+        const size_t hilos = static_cast<size_t>(omp_get_num_threads());
+        const size_t tid = static_cast<size_t>(omp_get_thread_num());
+        // Mismo tramo de bytes que recorre el hilo tid en un for estático.
+        const size_t desde = (base + bytes * tid / hilos - primera) / pagina;
+        const size_t hasta = tid + 1 == hilos ? paginas : (base + bytes * (tid + 1) / hilos - primera) / pagina;
+        const int nodo = currentNode();
+        constexpr size_t LOTE = 4096;
+        std::vector<void*> direcciones;
+        std::vector<int> destinos;
+        std::vector<int> estado;
+        for (size_t p = desde; p < hasta; p += LOTE) {
+            const size_t cuantas = std::min(LOTE, hasta - p);
+            direcciones.resize(cuantas);
+            destinos.assign(cuantas, nodo);
+            estado.assign(cuantas, -1);
+            for (size_t k = 0; k < cuantas; ++k) {
+                direcciones[k] = reinterpret_cast<void*>(primera + (p + k) * pagina);
+            }
+            if (::syscall(SYS_move_pages, 0, cuantas, direcciones.data(), destinos.data(), estado.data(), MOVER) >= 0) {
+                for (int e : estado) {
+                    movidas += e == nodo ? 1 : 0;
+                }
+            }
+        }
+    }
+#endif
+    return movidas;
+}
@@ -0,0 +1,526 @@
+#include "outofcore.hpp"
+#include "io.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+using std::size_t;
+
+namespace {
+
+// Punto propio de una partición con su posición en la entrada.
+struct Registro {
+    double x;
+    double y;
+    std::uint64_t indice;
+};
+
+// Copia de halo: `posicion` es su lugar en el archivo de propios de su partición
+// `dueno`, donde está su etiqueta después de la fase local.
+struct RegistroHalo {
+    double x;
+    double y;
+    std::uint64_t posicion;
+    std::uint64_t dueno;
+};
+
+struct Coordenadas {
+    double x;
+    double y;
+};
+
+double coordinate(const Coordenadas& c, int eje) { return eje == 0 ? c.x : c.y; }
+
+// Región [minimo, maximo) en cada eje; las de los bordes son infinitas.
+struct Region {
+    double minimo[2] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+    double maximo[2] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+
+    bool contains(const Coordenadas& c, double margen) const {
+        return c.x >= minimo[0] - margen && c.x < maximo[0] + margen &&
+               c.y >= minimo[1] - margen && c.y < maximo[1] + margen;
+    }
+};
+
+// Árbol de cortes: un nodo interno parte su región en `eje` (0 = x, 1 = y), con
+// coordenada < corte a la izquierda; una hoja es la partición `hoja`.
+struct NodoCorte {
+    int eje = -1;
+    double corte = 0.0;
+    size_t izquierda = 0;
+    size_t derecha = 0;
+    size_t hoja = 0;
+};
+
+class PartitionPlan {
+public:
+    // Parte recursivamente el plano, cada vez en la mediana de la muestra a lo largo
+    // del eje más extenso de la región, hasta que cada región más su halo de ancho
+    // `ancho` tenga a lo más `limite` puntos estimados (muestra · paso). Devuelve false
+    // si una región no baja de ahí con ningún corte; `estimado` queda con su tamaño.
+    bool build(std::vector<Coordenadas> muestra, double paso, double ancho, double limite,
+               const double minimos[2], const double maximos[2], double& estimado) {
+        paso_ = paso;
+        ancho_ = ancho;
+        limite_ = limite;
+        std::copy(minimos, minimos + 2, minimos_);
+        std::copy(maximos, maximos + 2, maximos_);
+        nodos_.clear();
+        regiones_.clear();
+        estimado = 0.0;
+        return split(Region{}, std::move(muestra), estimado);
+    }
+
+    size_t size() const { return regiones_.size(); }
+    const Region& region(size_t k) const { return regiones_[k]; }
+
+    size_t owner(double x, double y) const {
+        size_t nodo = 0;
+        while (nodos_[nodo].eje >= 0) {
+            const NodoCorte& c = nodos_[nodo];
+            nodo = (c.eje == 0 ? x : y) < c.corte ? c.izquierda : c.derecha;
+        }
+        return nodos_[nodo].hoja;
+    }
+
+    // f(k) para cada partición cuya región corta el cuadrado de lado 2·ancho en (x, y).
+    template <typename F>
+    void forEachNear(double x, double y, F&& f) const {
+        visit(0, x, y, f);
+    }
+
+private:
+    bool split(const Region& region, std::vector<Coordenadas> cercanos, double& estimado) {
+        const size_t nodo = nodos_.size();
+        nodos_.emplace_back();
+        if (static_cast<double>(cercanos.size()) * paso_ <= limite_) {
+            nodos_[nodo].hoja = regiones_.size();
+            regiones_.push_back(region);
+            return true;
+        }
+
+        // Primero el eje en que la región (recortada a la caja de los datos) es más larga.
+        auto extension = [&](int eje) {
+            return std::min(region.maximo[eje], maximos_[eje]) - std::max(region.minimo[eje], minimos_[eje]);
+        };
+        const int primero = extension(0) >= extension(1) ? 0 : 1;
+        for (int intento = 0; intento < 2; ++intento) {
+            const int eje = intento == 0 ? primero : 1 - primero;
+            std::vector<double> propios;
+            for (const Coordenadas& c : cercanos) {
+                if (region.contains(c, 0.0)) {
+                    propios.push_back(coordinate(c, eje));
+                }
+            }
+            if (propios.empty()) {
+                break;
+            }
+            auto medio = propios.begin() + static_cast<std::ptrdiff_t>(propios.size() / 2);
+            std::nth_element(propios.begin(), medio, propios.end());
+            const double corte = *medio;
+
+            Region izquierda = region;
+            Region derecha = region;
+            izquierda.maximo[eje] = corte;
+            derecha.minimo[eje] = corte;
+            std::vector<Coordenadas> de_izquierda, de_derecha;
+            for (const Coordenadas& c : cercanos) {
+                if (izquierda.contains(c, ancho_)) {
+                    de_izquierda.push_back(c);
+                }
+                if (derecha.contains(c, ancho_)) {
+                    de_derecha.push_back(c);
+                }
+            }
+            // Si un lado conserva todo, el corte no acerca la región al presupuesto.
+            if (de_izquierda.size() == cercanos.size() || de_derecha.size() == cercanos.size()) {
+                continue;
+            }
+            cercanos.clear();
+            cercanos.shrink_to_fit();
+            nodos_[nodo].eje = eje;
+            nodos_[nodo].corte = corte;
+            nodos_[nodo].izquierda = nodos_.size();
+            if (!split(izquierda, std::move(de_izquierda), estimado)) {
+                return false;
+            }
+            nodos_[nodo].derecha = nodos_.size();
+            return split(derecha, std::move(de_derecha), estimado);
+        }
+        estimado = static_cast<double>(cercanos.size()) * paso_;
+        return false;
+    }
+
+    template <typename F>
+    void visit(size_t nodo, double x, double y, F& f) const {
+        const NodoCorte& c = nodos_[nodo];
+        if (c.eje < 0) {
+            f(c.hoja);
+            return;
+        }
+        const double v = c.eje == 0 ? x : y;
+        if (v - ancho_ < c.corte) {
+            visit(c.izquierda, x, y, f);
+        }
+        if (v + ancho_ >= c.corte) {
+            visit(c.derecha, x, y, f);
+        }
+    }
+
+    double paso_ = 1.0;
+    double ancho_ = 0.0;
+    double limite_ = 0.0;
+    double minimos_[2] = {0.0, 0.0};
+    double maximos_[2] = {0.0, 0.0};
+    std::vector<NodoCorte> nodos_;
+    std::vector<Region> regiones_;
+};
+
+// Recorre la entrada en trozos de hasta `por_trozo` puntos y llama f(trozo, primer
+// índice). En CSV el trozo se mide en bytes (32 por punto) y se corta en un salto de
+// línea; las líneas que no se pueden leer no consumen índice, como en loadPoints.
+template <typename F>
+bool forEachChunk(const std::string& ruta, size_t por_trozo, F&& f) {
+    std::vector<Point> trozo;
+    if (isBinaryPath(ruta)) {
+        const MappedPoints mapa(ruta);
+        if (!mapa.ok() || mapa.dims() < 2) {
+            return false;
+        }
+        const double* xs = mapa.column(0);
+        const double* ys = mapa.column(1);
+        for (size_t inicio = 0; inicio < mapa.size(); inicio += por_trozo) {
+            const size_t fin = std::min(mapa.size(), inicio + por_trozo);
+            trozo.resize(fin - inicio);
+#pragma omp parallel for schedule(static)
+            for (size_t i = inicio; i < fin; ++i) {
+                trozo[i - inicio].x = xs[i];
+                trozo[i - inicio].y = ys[i];
+            }
+            f(trozo, static_cast<std::uint64_t>(inicio));
+        }
+        return true;
+    }
+
+    const MappedFile mapa(ruta);
+    if (!mapa.ok()) {
+        return false;
+    }
+    const char* data = mapa.data();
+    const size_t size = mapa.size();
+    std::uint64_t primero = 0;
+    for (size_t desde = 0; desde < size;) {
+        size_t hasta = std::min(size, desde + 32 * por_trozo);
+        while (hasta < size && data[hasta - 1] != '\n') {
+            ++hasta;
+        }
+        trozo = parsePointsCSV(data + desde, hasta - desde);
+        f(trozo, primero);
+        primero += trozo.size();
+        desde = hasta;
+    }
+    return true;
+}
+
+template <typename T>
+bool appendRecords(std::ofstream& out, const std::vector<T>& registros) {
+    out.write(reinterpret_cast<const char*>(registros.data()),
+              static_cast<std::streamsize>(registros.size() * sizeof(T)));
+    return static_cast<bool>(out);
+}
+
+template <typename T>
+std::vector<T> readRecords(const fs::path& archivo) {
+    std::vector<T> registros(fs::file_size(archivo) / sizeof(T));
+    std::ifstream in(archivo, std::ios::binary);
+    in.read(reinterpret_cast<char*>(registros.data()), static_cast<std::streamsize>(registros.size() * sizeof(T)));
+    return registros;
+}
+
+// Columna label de la salida proyectada con escritura, para guardar cada etiqueta en
+// la posición de su punto en la entrada sin tenerlas todas en memoria.
+class MappedLabelColumn {
+public:
+    MappedLabelColumn(const std::string& archivo, std::uint64_t offset, std::uint64_t count) {
+        fd_ = ::open(archivo.c_str(), O_RDWR);
+        if (fd_ < 0 || count == 0) {
+            return;
+        }
+        const auto pagina = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+        const std::uint64_t base = offset / pagina * pagina;
+        largo_ = static_cast<size_t>(offset - base + count * sizeof(std::int32_t));
+        void* p = ::mmap(nullptr, largo_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, static_cast<off_t>(base));
+        if (p == MAP_FAILED) {
+            return;
+        }
+        mapa_ = static_cast<char*>(p);
+        labels_ = reinterpret_cast<std::int32_t*>(mapa_ + (offset - base));
+    }
+
+    ~MappedLabelColumn() {
+        if (mapa_ != nullptr) {
+            ::munmap(mapa_, largo_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    MappedLabelColumn(const MappedLabelColumn&) = delete;
+    MappedLabelColumn& operator=(const MappedLabelColumn&) = delete;
+
+    std::int32_t* data() const { return labels_; }
+
+private:
+    int fd_ = -1;
+    char* mapa_ = nullptr;
+    size_t largo_ = 0;
+    std::int32_t* labels_ = nullptr;
+};
+
+}
+
+OutOfCoreResult dbscan_out_of_core(const std::string& ruta,
+                                   const std::string& salida,
+                                   double epsilon,
+                                   int min_samples,
+                                   const OutOfCoreOptions& opciones) {
+    OutOfCoreResult resultado;
+    const size_t memoria = std::max<size_t>(opciones.memoria, std::size_t{1} << 16);
+    auto megas = [](double bytes) { return bytes / static_cast<double>(std::size_t{1} << 20); };
+    // Los trozos de lectura usan una cuarta parte del presupuesto.
+    const size_t por_trozo = std::max<size_t>(1024, memoria / 4 / sizeof(Point));
+    double marca = omp_get_wtime();
+
+    // 1. Escaneo. La muestra guarda uno de cada `paso` puntos y, al llegar al doble del
+    // tamaño buscado, descarta la mitad y duplica el paso.
+    constexpr size_t MUESTRA = std::size_t{1} << 20;
+    std::vector<Coordenadas> muestra;
+    std::uint64_t paso = 1;
+    std::uint64_t n = 0;
+    double minimos[2] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+    double maximos[2] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+    const bool leida = forEachChunk(ruta, por_trozo, [&](const std::vector<Point>& trozo, std::uint64_t) {
+        for (const Point& p : trozo) {
+            minimos[0] = std::min(minimos[0], p.x);
+            minimos[1] = std::min(minimos[1], p.y);
+            maximos[0] = std::max(maximos[0], p.x);
+            maximos[1] = std::max(maximos[1], p.y);
+            if (n % paso == 0) {
+                muestra.push_back({p.x, p.y});
+                if (muestra.size() >= 2 * MUESTRA) {
+                    for (size_t k = 0; k < MUESTRA; ++k) {
+                        muestra[k] = muestra[2 * k];
+                    }
+                    muestra.resize(MUESTRA);
+                    paso *= 2;
+                }
+            }
+            ++n;
+        }
+    });
+    resultado.total = n;
+    if (!leida || n == 0) {
+        resultado.error = "no se pudieron leer puntos de " + ruta;
+        return resultado;
+    }
+
+    // Particiones: regiones cuyo conteo estimado, propios más halo, cabe en el
+    // presupuesto. Con la muestra diezmada se deja un cuarto de margen para su error.
+    // El margen en el halo cubre el redondeo de dx·dx frente a eps² para vecinos a
+    // distancia exactamente epsilon.
+    const double ancho = epsilon * (1.0 + 1e-9);
+    const size_t capacidad = memoria / OOC_BYTES_POR_PUNTO;
+    const double limite = static_cast<double>(capacidad) * (paso == 1 ? 1.0 : 0.75);
+    PartitionPlan plan;
+    double estimado = 0.0;
+    if (!plan.build(std::move(muestra), static_cast<double>(paso), ancho, limite, minimos, maximos, estimado)) {
+        std::ostringstream motivo;
+        motivo << "una región de la entrada tiene ~" << static_cast<std::uint64_t>(estimado)
+               << " puntos con su halo (~" << megas(estimado * OOC_BYTES_POR_PUNTO)
+               << " MB) y ningún corte la reduce; el presupuesto de " << megas(memoria)
+               << " MB no alcanza con epsilon = " << epsilon;
+        resultado.error = motivo.str();
+        return resultado;
+    }
+    const size_t particiones = plan.size();
+    resultado.particiones = particiones;
+    resultado.escaneo = omp_get_wtime() - marca;
+    marca = omp_get_wtime();
+
+    const fs::path temporal = opciones.temporal.empty()
+        ? fs::path(salida).parent_path() / ("ooc_" + std::to_string(::getpid()))
+        : fs::path(opciones.temporal);
+    fs::create_directories(temporal);
+    auto archivo = [&](const char* tipo, size_t k) { return temporal / (std::string(tipo) + "_" + std::to_string(k) + ".bin"); };
+
+    // 2. Reparto en particiones.
+    BinaryPointWriter escritor(salida, n, true, true);
+    bool ok = escritor.ok();
+    std::vector<std::ofstream> propios_out(particiones), halo_out(particiones);
+    for (size_t k = 0; k < particiones; ++k) {
+        propios_out[k].open(archivo("propios", k), std::ios::binary);
+        halo_out[k].open(archivo("halo", k), std::ios::binary);
+        ok = ok && propios_out[k] && halo_out[k];
+    }
+    std::vector<std::uint64_t> contadores(particiones, 0), contadores_halo(particiones, 0);
+    std::vector<std::vector<Registro>> propios(particiones);
+    std::vector<std::vector<RegistroHalo>> halo(particiones);
+    std::vector<double> xs, ys;
+    std::vector<size_t> particion;
+    forEachChunk(ruta, por_trozo, [&](const std::vector<Point>& trozo, std::uint64_t primero) {
+        const size_t m = trozo.size();
+        xs.resize(m);
+        ys.resize(m);
+        particion.resize(m);
+#pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < m; ++i) {
+            xs[i] = trozo[i].x;
+            ys[i] = trozo[i].y;
+            particion[i] = plan.owner(trozo[i].x, trozo[i].y);
+        }
+        const std::vector<std::int32_t> ruido(m, NOISE);
+        ok = ok && escritor.write(primero, xs.data(), ys.data(), m) &&
+             escritor.writeLabels(primero, ruido.data(), ruido.data(), m);
+
+        for (size_t i = 0; i < m; ++i) {
+            const size_t k = particion[i];
+            const std::uint64_t posicion = contadores[k]++;
+            propios[k].push_back({xs[i], ys[i], primero + i});
+            plan.forEachNear(xs[i], ys[i], [&](size_t q) {
+                if (q != k) {
+                    halo[q].push_back({xs[i], ys[i], posicion, k});
+                }
+            });
+        }
+        for (size_t k = 0; k < particiones; ++k) {
+            contadores_halo[k] += halo[k].size();
+            ok = ok && appendRecords(propios_out[k], propios[k]) && appendRecords(halo_out[k], halo[k]);
+            propios[k].clear();
+            halo[k].clear();
+        }
+    });
+    propios_out.clear();
+    halo_out.clear();
+    resultado.reparto = omp_get_wtime() - marca;
+    marca = omp_get_wtime();
+
+    // El plan sale de una muestra: antes de cargar nada se comprueba con los conteos
+    // exactos que ninguna partición pase del presupuesto.
+    for (size_t k = 0; k < particiones; ++k) {
+        const size_t tamano = static_cast<size_t>(contadores[k] + contadores_halo[k]);
+        resultado.halo += contadores_halo[k];
+        resultado.mayor = std::max(resultado.mayor, tamano);
+    }
+    if (ok && resultado.mayor > capacidad) {
+        std::ostringstream motivo;
+        motivo << "la mayor partición tiene " << resultado.mayor << " puntos con su halo (~"
+               << megas(static_cast<double>(resultado.mayor * OOC_BYTES_POR_PUNTO)) << " MB), más que el presupuesto de "
+               << megas(memoria) << " MB; la muestra subestimó su densidad";
+        resultado.error = motivo.str();
+        ok = false;
+    }
+
+    // 3. Una partición con su halo a la vez. Se guardan las etiquetas de los propios y
+    // cuáles puntos del halo fueron core localmente.
+    Clusterer clusterer(opciones.engine, opciones.num_threads, opciones.block_size);
+    std::vector<Point> local;
+    for (size_t k = 0; k < particiones && ok; ++k) {
+        const std::vector<Registro> mios = readRecords<Registro>(archivo("propios", k));
+        const std::vector<RegistroHalo> vecinos = readRecords<RegistroHalo>(archivo("halo", k));
+        local.resize(mios.size() + vecinos.size());
+        for (size_t i = 0; i < mios.size(); ++i) {
+            local[i].x = mios[i].x;
+            local[i].y = mios[i].y;
+        }
+        for (size_t i = 0; i < vecinos.size(); ++i) {
+            local[mios.size() + i].x = vecinos[i].x;
+            local[mios.size() + i].y = vecinos[i].y;
+        }
+        clusterer.run(local, epsilon, min_samples);
+
+        std::vector<std::int8_t> etiquetas(mios.size()), halo_core(vecinos.size());
+        for (size_t i = 0; i < mios.size(); ++i) {
+            etiquetas[i] = static_cast<std::int8_t>(local[i].label);
+        }
+        for (size_t i = 0; i < vecinos.size(); ++i) {
+            halo_core[i] = local[mios.size() + i].label == CORE1 ? 1 : 0;
+        }
+        std::ofstream etiquetas_out(archivo("etiquetas", k), std::ios::binary);
+        std::ofstream halo_core_out(archivo("halo_core", k), std::ios::binary);
+        ok = appendRecords(etiquetas_out, etiquetas) && appendRecords(halo_core_out, halo_core);
+    }
+    std::vector<Point>().swap(local);
+    resultado.local = omp_get_wtime() - marca;
+    marca = omp_get_wtime();
+
+    // 4. Reconciliación y escritura de etiquetas en el orden de la entrada.
+    {
+        std::vector<MappedFile> etiquetas;
+        etiquetas.reserve(particiones);
+        for (size_t k = 0; k < particiones && ok; ++k) {
+            etiquetas.emplace_back(archivo("etiquetas", k).string());
+        }
+        const MappedLabelColumn columna(salida, escritor.labelsOffset(), n);
+        std::int32_t* destino = columna.data();
+        ok = ok && destino != nullptr;
+        const double eps2 = epsilon * epsilon;
+        for (size_t k = 0; k < particiones && ok; ++k) {
+            const std::vector<RegistroHalo> vecinos = readRecords<RegistroHalo>(archivo("halo", k));
+            const std::vector<std::int8_t> halo_core = readRecords<std::int8_t>(archivo("halo_core", k));
+            std::vector<Point> faltantes;
+            for (size_t i = 0; i < vecinos.size(); ++i) {
+                const auto* suyas = reinterpret_cast<const std::int8_t*>(etiquetas[vecinos[i].dueno].data());
+                if (halo_core[i] == 0 && suyas[vecinos[i].posicion] == CORE1) {
+                    Point p;
+                    p.x = vecinos[i].x;
+                    p.y = vecinos[i].y;
+                    faltantes.push_back(p);
+                }
+            }
+            resultado.promovidos += faltantes.size();
+            PointsSoA cores_halo;
+            cores_halo.assign(faltantes);
+
+            const std::vector<Registro> mios = readRecords<Registro>(archivo("propios", k));
+            const auto* mias = reinterpret_cast<const std::int8_t*>(etiquetas[k].data());
+            // Solo los propios a menos de epsilon del borde de la región tienen vecinos en el halo.
+            Region interior = plan.region(k);
+            for (int eje = 0; eje < 2; ++eje) {
+                interior.minimo[eje] += ancho;
+                interior.maximo[eje] -= ancho;
+            }
+#pragma omp parallel for schedule(dynamic, 4096)
+            for (size_t i = 0; i < mios.size(); ++i) {
+                int label = mias[i];
+                if (label == NOISE && cores_halo.size() > 0 && !interior.contains({mios[i].x, mios[i].y}, 0.0) &&
+                    anyWithin(mios[i].x, mios[i].y, cores_halo.x.data(), cores_halo.y.data(), cores_halo.size(), eps2)) {
+                    label = CORE2;
+                }
+                destino[mios[i].indice] = label;
+            }
+        }
+    }
+    ok = escritor.close(minimos, maximos) && ok;
+    resultado.reconciliacion = omp_get_wtime() - marca;
+
+    std::error_code error;
+    fs::remove_all(temporal, error);
+    resultado.ok = ok;
+    if (!ok && resultado.error.empty()) {
+        resultado.error = "no se pudieron escribir las particiones o " + salida;
+    }
+    return resultado;
+}
@@ -1,19 +1,26 @@
 #include "dbscan.hpp"
+#include "clusterer.hpp"
+#include "pair_count.hpp"
+#include "soa.hpp"
 
 #include <omp.h>
 
+#include <algorithm>
 #include <vector>
 
 using std::size_t;
 
-std::vector<Point> dbscan_parallel_full(const std::string& ruta, 
-                                        double epsilon, 
-                                        int min_samples, 
-                                        int num_threads) {
-    std::vector<Point> puntos = loadPoints(ruta);
+void dbscan_parallel_full(std::vector<Point>& puntos,
+                          double epsilon,
+                          int min_samples,
+                          int num_threads,
+                          Workspace& ws) {
+    PhaseClock reloj(ws.perf);
+    ws.fases = PhaseTimes{};
+    resetLabels(puntos);
     const size_t n = puntos.size();
     if (n == 0) {
-        return puntos;
+        return;
     }
 
     if (num_threads > 0) {
@@ -21,20 +28,32 @@ std::vector<Point> dbscan_parallel_full(const std::string& ruta,
     }
 
     const double eps2 = epsilon * epsilon;
-    std::vector<int> vecinos(n, 0);
+    FirstTouchVector<int>& vecinos = ws.vecinos;
+    firstTouchAssign(vecinos, n, 0);
+    PointsSoA& soa = ws.soa;
+    soa.assign(puntos);
 
-#pragma omp parallel for schedule(static)
-    for (size_t i = 0; i < n; ++i) {
-        for (size_t j = i + 1; j < n; ++j) {
-            if (distanceSquared(puntos[i], puntos[j]) <= eps2) {
-#pragma omp atomic
-                ++vecinos[i];
-#pragma omp atomic
-                ++vecinos[j];
-            }
-        }
+    if (prepareNeighborLists(ws, n, min_samples)) {
+        firstTouchAssign(ws.llenado, n, 0);
+    }
+
+    // Cada hilo suma en su propio arreglo de conteos y al final se reducen; solo si
+    // no caben (hilos * n muy grande) se cuenta con atómicos sobre vecinos.
+    const size_t hilos = static_cast<size_t>(omp_get_max_threads());
+    int* privados = preparePrivateCounts(ws, n, hilos);
+
+    ws.fases.preparacion = reloj.lap(ws.perf.preparacion);
+    if (ws.perf.activo) {
+        ws.perf.conteo.prepareBusy(hilos);
     }
 
+    countPairsByRows(n, ws, privados, [&](size_t i, size_t j0, size_t len) {
+        return maskWithin(soa.x[i], soa.y[i], &soa.x[j0], &soa.y[j0], len, eps2);
+    });
+
+    ws.fases.conteo = reloj.lap(ws.perf.conteo);
+    ws.fases.pares = static_cast<double>(n) * static_cast<double>(n - 1) / 2.0;
+
 #pragma omp parallel for schedule(static)
     for (size_t i = 0; i < n; ++i) {
         if (vecinos[i] >= min_samples) {
@@ -42,20 +61,18 @@ std::vector<Point> dbscan_parallel_full(const std::string& ruta,
         }
     }
 
-#pragma omp parallel for schedule(static)
-    for (size_t i = 0; i < n; ++i) {
-        if (puntos[i].label != NOISE) {
-            continue;
-        }
-        for (size_t j = 0; j < n; ++j) {
-            if (puntos[j].label == CORE1 &&
-                distanceSquared(puntos[i], puntos[j]) <= eps2) {
-                puntos[i].label = CORE2;
-                break;
-            }
-        }
-    }
+    ws.fases.cores = reloj.lap(ws.perf.cores);
 
-    return puntos;
+    assignBorders(puntos, ws, eps2, true);
+    ws.fases.frontera = reloj.lap(ws.perf.frontera);
 }
 
+std::vector<Point> dbscan_parallel_full(const std::string& ruta, 
+                                        double epsilon, 
+                                        int min_samples, 
+                                        int num_threads) {
+    std::vector<Point> puntos = loadPoints(ruta);
+    Workspace ws;
+    dbscan_parallel_full(puntos, epsilon, min_samples, num_threads, ws);
+    return puntos;
+}
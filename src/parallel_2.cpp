@@ -1,30 +1,24 @@
 #include "dbscan.hpp"
+#include "clusterer.hpp"
+#include "pair_count.hpp"
+#include "soa.hpp"
 
 #include <omp.h>
 
-#include <algorithm>
 #include <vector>
 
-namespace {
-
-std::size_t computeBlockCount(std::size_t n, std::size_t block_size) {
-    if (block_size == 0) {
-        block_size = 512;
-    }
-    return (n + block_size - 1) / block_size;
-}
-
-} 
-
-std::vector<Point> dbscan_parallel_divided(const std::string& ruta,
-                                           double epsilon,
-                                           int min_samples,
-                                           int num_threads,
-                                           std::size_t block_size) {
-    std::vector<Point> puntos = loadPoints(ruta);
+void dbscan_parallel_divided(std::vector<Point>& puntos,
+                             double epsilon,
+                             int min_samples,
+                             int num_threads,
+                             std::size_t block_size,
+                             Workspace& ws) {
+    PhaseClock reloj(ws.perf);
+    ws.fases = PhaseTimes{};
+    resetLabels(puntos);
     const std::size_t n = puntos.size();
     if (n == 0) {
-        return puntos;
+        return;
     }
 
     if (num_threads > 0) {
@@ -35,79 +29,39 @@ std::vector<Point> dbscan_parallel_divided(const std::string& ruta,
         block_size = 512;
     }
 
-    const std::size_t block_count = computeBlockCount(n, block_size);
     const double eps2 = epsilon * epsilon;
-    std::vector<int> vecinos(n, 0);
-
-#pragma omp parallel
-    {
-        std::vector<int> local_i;
-        std::vector<int> local_j;
-
-#pragma omp for schedule(dynamic)
-        for (std::size_t bi = 0; bi < block_count; ++bi) {
-            const std::size_t i_begin = bi * block_size;
-            const std::size_t i_end = std::min(n, i_begin + block_size);
-            const std::size_t i_block = i_end - i_begin;
-            if (i_block == 0) {
-                continue;
-            }
-
-            local_i.assign(i_block, 0);
-
-            for (std::size_t bj = bi; bj < block_count; ++bj) {
-                const std::size_t j_begin = bj * block_size;
-                const std::size_t j_end = std::min(n, j_begin + block_size);
-                const std::size_t j_block = j_end - j_begin;
-                if (j_block == 0) {
-                    continue;
-                }
-
-                if (bj != bi) {
-                    local_j.assign(j_block, 0);
-                }
-
-                if (bi == bj) {
-                    for (std::size_t ii = i_begin; ii < i_end; ++ii) {
-                        const std::size_t local_ii = ii - i_begin;
-                        for (std::size_t jj = ii + 1; jj < i_end; ++jj) {
-                            if (distanceSquared(puntos[ii], puntos[jj]) <= eps2) {
-                                ++local_i[local_ii];
-                                ++local_i[jj - i_begin];
-                            }
-                        }
-                    }
-                } else {
-                    for (std::size_t ii = i_begin; ii < i_end; ++ii) {
-                        const std::size_t local_ii = ii - i_begin;
-                        for (std::size_t jj = j_begin; jj < j_end; ++jj) {
-                            if (distanceSquared(puntos[ii], puntos[jj]) <= eps2) {
-                                ++local_i[local_ii];
-                                ++local_j[jj - j_begin];
-                            }
-                        }
-                    }
-
-                    for (std::size_t offset = 0; offset < j_block; ++offset) {
-                        const int value = local_j[offset];
-                        if (value != 0) {
-#pragma omp atomic
-                            vecinos[j_begin + offset] += value;
-                        }
-                    }
-                }
-            }
-
-            for (std::size_t offset = 0; offset < i_block; ++offset) {
-                const int value = local_i[offset];
-                if (value != 0) {
-#pragma omp atomic
-                    vecinos[i_begin + offset] += value;
-                }
-            }
-        }
+    FirstTouchVector<int>& vecinos = ws.vecinos;
+    firstTouchAssign(vecinos, n, 0);
+    PointsSoA& soa = ws.soa;
+    soa.assign(puntos);
+
+    if (prepareNeighborLists(ws, n, min_samples)) {
+        firstTouchAssign(ws.llenado, n, 0);
     }
 
+    const std::size_t hilos = static_cast<std::size_t>(omp_get_max_threads());
+    int* privados = preparePrivateCounts(ws, n, hilos);
+
+    // Mosaicos cuyas cajas están a más de epsilon no tienen pares vecinos. En el orden
+    // de la entrada casi ninguno se descarta; con orden espacial, casi todos.
+    blockBoxes(soa, block_size, ws.cajas);
+    const Caja* cajas = ws.cajas.data();
+
+    ws.fases.preparacion = reloj.lap(ws.perf.preparacion);
+    if (ws.perf.activo) {
+        ws.perf.conteo.prepareBusy(hilos);
+    }
+
+    const double pares = countPairsByTiles(
+        n, block_size, ws, privados,
+        [&](std::size_t i, std::size_t j0, std::size_t len) {
+            return maskWithin(soa.x[i], soa.y[i], &soa.x[j0], &soa.y[j0], len, eps2);
+        },
+        [&](std::size_t bi, std::size_t bj) { return boxGapSquared(cajas[bi], cajas[bj]) > eps2; });
+
+    ws.fases.conteo = reloj.lap(ws.perf.conteo);
+    ws.fases.pares = pares;
+
 #pragma omp parallel for schedule(static)
     for (std::size_t i = 0; i < n; ++i) {
         if (vecinos[i] >= min_samples) {
@@ -115,20 +69,19 @@ std::vector<Point> dbscan_parallel_divided(const std::string& ruta,
         }
     }
 
-#pragma omp parallel for schedule(static)
-    for (std::size_t i = 0; i < n; ++i) {
-        if (puntos[i].label != NOISE) {
-            continue;
-        }
-        for (std::size_t j = 0; j < n; ++j) {
-            if (puntos[j].label == CORE1 &&
-                distanceSquared(puntos[i], puntos[j]) <= eps2) {
-                puntos[i].label = CORE2;
-                break;
-            }
-        }
-    }
+    ws.fases.cores = reloj.lap(ws.perf.cores);
 
-    return puntos;
+    assignBorders(puntos, ws, eps2, true);
+    ws.fases.frontera = reloj.lap(ws.perf.frontera);
 }
 
+std::vector<Point> dbscan_parallel_divided(const std::string& ruta,
+                                           double epsilon,
+                                           int min_samples,
+                                           int num_threads,
+                                           std::size_t block_size) {
+    std::vector<Point> puntos = loadPoints(ruta);
+    Workspace ws;
+    dbscan_parallel_divided(puntos, epsilon, min_samples, num_threads, block_size, ws);
+    return puntos;
+}
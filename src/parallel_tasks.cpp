@@ -0,0 +1,272 @@
+#include "dbscan.hpp"
+#include "clusterer.hpp"
+#include "grid.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using std::size_t;
+
+namespace {
+
+// Un vecino encontrado cuesta bastante más que una distancia descartada: incrementa
+// conteos y, con lista, hace dos registros atómicos.
+constexpr double COSTO_VECINO = 16.0;
+
+// Lado mínimo de un sub-mosaico; por debajo no vale la pena crear otra tarea.
+constexpr size_t MOSAICO_MIN = 64;
+
+// Rango de filas [i0, i1) contra columnas [j0, j1). Si es diagonal ambos rangos son
+// el mismo y solo se recorre j > i.
+struct Mosaico {
+    size_t i0, i1, j0, j1;
+    bool diagonal;
+    double costo_par;  // costo estimado por par, según la densidad de la zona
+
+    double pairs() const {
+        const double ni = static_cast<double>(i1 - i0);
+        return diagonal ? ni * (ni - 1.0) / 2.0 : ni * static_cast<double>(j1 - j0);
+    }
+    double cost() const { return pairs() * costo_par; }
+};
+
+struct Contexto {
+    const PointsSoA* soa;
+    double eps2;
+    double umbral;
+    bool usa_lista;
+    size_t cap;
+    int* lista;
+    int* llenado;
+    int* privados;
+    int* compartidos;
+    size_t n;
+    std::vector<std::vector<int>>* locales;
+    PhasePerf* perf;
+};
+
+void countTile(const Contexto& ctx, const Mosaico& m) {
+    BusyTimer ocupado(*ctx.perf);
+    const PointsSoA& soa = *ctx.soa;
+    const size_t tid = static_cast<size_t>(omp_get_thread_num());
+    std::vector<int>& local_i = (*ctx.locales)[2 * tid];
+    std::vector<int>& local_j = (*ctx.locales)[2 * tid + 1];
+    local_i.assign(m.i1 - m.i0, 0);
+    local_j.assign(m.diagonal ? 0 : m.j1 - m.j0, 0);
+
+    for (size_t ii = m.i0; ii < m.i1; ++ii) {
+        const size_t desde = m.diagonal ? ii + 1 : m.j0;
+        for (size_t j0 = desde; j0 < m.j1; j0 += 64) {
+            const size_t len = std::min<size_t>(64, m.j1 - j0);
+            std::uint64_t mask = maskWithin(soa.x[ii], soa.y[ii], &soa.x[j0], &soa.y[j0], len, ctx.eps2);
+            local_i[ii - m.i0] += popcount64(mask);
+            while (mask != 0) {
+                const size_t jj = j0 + lowestBit64(mask);
+                if (m.diagonal) {
+                    ++local_i[jj - m.i0];
+                } else {
+                    ++local_j[jj - m.j0];
+                }
+                if (ctx.usa_lista) {
+                    recordNeighbor(ctx.llenado, ctx.lista, ctx.cap, ii, jj);
+                    recordNeighbor(ctx.llenado, ctx.lista, ctx.cap, jj, ii);
+                }
+                mask &= mask - 1;
+            }
+        }
+    }
+
+    // Las tareas son tied: el hilo que empezó el mosaico lo termina, así que su
+    // arreglo privado no lo toca nadie más.
+    int* mio = ctx.privados != nullptr ? ctx.privados + tid * ctx.n : nullptr;
+    auto descargar = [&](const std::vector<int>& local, size_t begin) {
+        for (size_t offset = 0; offset < local.size(); ++offset) {
+            const int value = local[offset];
+            if (value == 0) {
+                continue;
+            }
+            if (mio != nullptr) {
+                mio[begin + offset] += value;
+            } else {
+#pragma omp atomic
+                ctx.compartidos[begin + offset] += value;
+            }
+        }
+    };
+    descargar(local_i, m.i0);
+    descargar(local_j, m.j0);
+}
+
+// Los mosaicos caros se parten en tareas más chicas para que los hilos libres las
+// roben; los baratos se cuentan de una vez.
+void processTile(const Contexto& ctx, const Mosaico& m) {
+    const size_t ni = m.i1 - m.i0;
+    const size_t nj = m.j1 - m.j0;
+    if (m.cost() <= ctx.umbral || std::max(ni, nj) < 2 * MOSAICO_MIN) {
+        countTile(ctx, m);
+        return;
+    }
+
+    Mosaico hijos[3];
+    size_t cuantos = 0;
+    if (m.diagonal) {
+        const size_t medio = m.i0 + ni / 2;
+        hijos[cuantos++] = {m.i0, medio, m.i0, medio, true, m.costo_par};
+        hijos[cuantos++] = {medio, m.i1, medio, m.i1, true, m.costo_par};
+        hijos[cuantos++] = {m.i0, medio, medio, m.i1, false, m.costo_par};
+    } else if (ni >= nj) {
+        const size_t medio = m.i0 + ni / 2;
+        hijos[cuantos++] = {m.i0, medio, m.j0, m.j1, false, m.costo_par};
+        hijos[cuantos++] = {medio, m.i1, m.j0, m.j1, false, m.costo_par};
+    } else {
+        const size_t medio = m.j0 + nj / 2;
+        hijos[cuantos++] = {m.i0, m.i1, m.j0, medio, false, m.costo_par};
+        hijos[cuantos++] = {m.i0, m.i1, medio, m.j1, false, m.costo_par};
+    }
+    for (size_t h = 0; h < cuantos; ++h) {
+        const Mosaico hijo = hijos[h];
+#pragma omp task firstprivate(hijo) shared(ctx)
+        processTile(ctx, hijo);
+    }
+}
+
+}
+
+void dbscan_parallel_tasks(std::vector<Point>& puntos,
+                           double epsilon,
+                           int min_samples,
+                           int num_threads,
+                           size_t block_size,
+                           Workspace& ws) {
+    PhaseClock reloj(ws.perf);
+    ws.fases = PhaseTimes{};
+    resetLabels(puntos);
+    const size_t n = puntos.size();
+    if (n == 0) {
+        return;
+    }
+
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+    if (block_size == 0) {
+        block_size = 512;
+    }
+
+    const double eps2 = epsilon * epsilon;
+    FirstTouchVector<int>& vecinos = ws.vecinos;
+    firstTouchAssign(vecinos, n, 0);
+    PointsSoA& soa = ws.soa;
+    soa.assign(puntos);
+
+    const bool usa_lista = prepareNeighborLists(ws, n, min_samples);
+    if (usa_lista) {
+        firstTouchAssign(ws.llenado, n, 0);
+    }
+
+    const size_t hilos = static_cast<size_t>(omp_get_max_threads());
+    if (ws.locales.size() < 2 * hilos) {
+        ws.locales.resize(2 * hilos);
+    }
+    int* privados = preparePrivateCounts(ws, n, hilos);
+
+    // Estimación de costo por bloque: caja envolvente y fracción de los n puntos que
+    // cae en el vecindario 3x3 de la grilla de sus puntos (ocupación de celdas).
+    const size_t block_count = (n + block_size - 1) / block_size;
+    buildGrid(puntos, epsilon, ws.grid);
+    const GridIndex& grid = ws.grid;
+    std::vector<Caja> cajas(block_count);
+    std::vector<double> densidad(block_count);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t b = 0; b < block_count; ++b) {
+        const size_t inicio = b * block_size;
+        const size_t fin = std::min(n, inicio + block_size);
+        Caja caja{soa.x[inicio], soa.x[inicio], soa.y[inicio], soa.y[inicio]};
+        double ocupacion = 0.0;
+        for (size_t i = inicio; i < fin; ++i) {
+            caja.min_x = std::min(caja.min_x, soa.x[i]);
+            caja.max_x = std::max(caja.max_x, soa.x[i]);
+            caja.min_y = std::min(caja.min_y, soa.y[i]);
+            caja.max_y = std::max(caja.max_y, soa.y[i]);
+            grid.forEachNeighborRange(grid.celda[i], [&](size_t q_ini, size_t q_fin) {
+                ocupacion += static_cast<double>(q_fin - q_ini);
+            });
+        }
+        cajas[b] = caja;
+        densidad[b] = ocupacion / (static_cast<double>(fin - inicio) * static_cast<double>(n));
+    }
+
+    // Mosaicos cuyas cajas están a más de epsilon no tienen pares vecinos.
+    std::vector<Mosaico> mosaicos;
+    mosaicos.reserve(block_count * (block_count + 1) / 2);
+    for (size_t bi = 0; bi < block_count; ++bi) {
+        for (size_t bj = bi; bj < block_count; ++bj) {
+            if (bj != bi && boxGapSquared(cajas[bi], cajas[bj]) > eps2) {
+                continue;
+            }
+            const double vecindad = std::min(1.0, std::min(densidad[bi], densidad[bj]));
+            mosaicos.push_back({bi * block_size, std::min(n, (bi + 1) * block_size),
+                                bj * block_size, std::min(n, (bj + 1) * block_size),
+                                bi == bj, 1.0 + COSTO_VECINO * vecindad});
+        }
+    }
+    // Los más caros primero: las tareas que quedan al final son las chicas.
+    std::sort(mosaicos.begin(), mosaicos.end(),
+              [](const Mosaico& a, const Mosaico& b) { return a.cost() > b.cost(); });
+    const double total = std::accumulate(mosaicos.begin(), mosaicos.end(), 0.0,
+                                         [](double suma, const Mosaico& m) { return suma + m.cost(); });
+    const double pares = std::accumulate(mosaicos.begin(), mosaicos.end(), 0.0,
+                                         [](double suma, const Mosaico& m) { return suma + m.pairs(); });
+
+    Contexto ctx{&soa, eps2, total / static_cast<double>(hilos * 16), usa_lista,
+                 ws.capacidad, ws.lista.data(), ws.llenado.data(), privados, vecinos.data(), n,
+                 &ws.locales, &ws.perf.conteo};
+
+    ws.fases.preparacion = reloj.lap(ws.perf.preparacion);
+    // Solo cuenta el tiempo dentro de countTile: crear y robar tareas es ocio.
+    if (ws.perf.activo) {
+        ws.perf.conteo.prepareBusy(hilos);
+    }
+
+#pragma omp parallel
+#pragma omp single
+    for (const Mosaico& m : mosaicos) {
+#pragma omp task firstprivate(m) shared(ctx)
+        processTile(ctx, m);
+    }
+
+    if (privados != nullptr) {
+        reducePrivateCounts(ws, n);
+    }
+
+    ws.fases.conteo = reloj.lap(ws.perf.conteo);
+    ws.fases.pares = pares;
+
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        if (vecinos[i] >= min_samples) {
+            puntos[i].label = CORE1;
+        }
+    }
+
+    ws.fases.cores = reloj.lap(ws.perf.cores);
+
+    assignBorders(puntos, ws, eps2, true);
+    ws.fases.frontera = reloj.lap(ws.perf.frontera);
+}
+
+std::vector<Point> dbscan_parallel_tasks(const std::string& ruta,
+                                         double epsilon,
+                                         int min_samples,
+                                         int num_threads,
+                                         size_t block_size) {
+    std::vector<Point> puntos = loadPoints(ruta);
+    Workspace ws;
+    dbscan_parallel_tasks(puntos, epsilon, min_samples, num_threads, block_size, ws);
+    return puntos;
+}
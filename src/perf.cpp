@@ -0,0 +1,231 @@
+#include "perf.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<std::uint64_t> siguiente_ronda{1};
+
+#ifdef __linux__
+
+struct EventoPerf {
+    std::uint32_t tipo;
+    std::uint64_t config;
+};
+
+// PERF_COUNT_HW_CACHE_MISSES es el evento genérico de fallos de último nivel de caché.
+constexpr EventoPerf EVENTOS[PERF_EVENTOS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int openCounter(const EventoPerf& evento) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = evento.tipo;
+    attr.config = evento.config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid = 0, cpu = -1: el hilo que llama, en cualquier CPU.
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+// Descriptores del hilo actual; se abren en la primera lectura y se cierran cuando
+// el hilo termina.
+struct ContadoresHilo {
+    int fd[PERF_EVENTOS] = {-1, -1, -1, -1};
+    bool abierto = false;
+    std::uint64_t ronda = 0;
+    PerfCounts anterior;
+
+    ~ContadoresHilo() {
+        for (int f : fd) {
+            if (f >= 0) {
+                ::close(f);
+            }
+        }
+    }
+
+    void open() {
+        abierto = true;
+        for (int e = 0; e < PERF_EVENTOS; ++e) {
+            fd[e] = openCounter(EVENTOS[e]);
+        }
+    }
+
+    // Si el kernel multiplexó el contador se escala por tiempo habilitado / activo.
+    PerfCounts read() {
+        if (!abierto) {
+            open();
+        }
+        PerfCounts lectura;
+        for (int e = 0; e < PERF_EVENTOS; ++e) {
+            std::uint64_t datos[3] = {};
+            if (fd[e] < 0 || ::read(fd[e], datos, sizeof(datos)) != static_cast<ssize_t>(sizeof(datos))) {
+                continue;
+            }
+            std::uint64_t valor = datos[0];
+            if (datos[2] != 0 && datos[2] < datos[1]) {
+                valor = static_cast<std::uint64_t>(static_cast<double>(valor) * static_cast<double>(datos[1]) /
+                                                   static_cast<double>(datos[2]));
+            }
+            lectura.valores[e] = valor;
+            lectura.valido[e] = true;
+        }
+        return lectura;
+    }
+};
+
+#else
+
+// Sin perf_event_open: ninguna lectura es válida.
+struct ContadoresHilo {
+    std::uint64_t ronda = 0;
+    PerfCounts anterior;
+
+    PerfCounts read() { return {}; }
+};
+
+#endif
+
+thread_local ContadoresHilo contadores;
+
+PerfCounts difference(const PerfCounts& actual, const PerfCounts& anterior) {
+    PerfCounts diff;
+    for (int e = 0; e < PERF_EVENTOS; ++e) {
+        diff.valido[e] = actual.valido[e] && anterior.valido[e];
+        diff.valores[e] = diff.valido[e] && actual.valores[e] >= anterior.valores[e]
+            ? actual.valores[e] - anterior.valores[e]
+            : 0;
+    }
+    return diff;
+}
+
+void clearPhase(PhasePerf& fase) {
+    fase.hilos.clear();
+    fase.ocupado.clear();
+    fase.pared = 0.0;
+}
+
+}
+
+const char* perfEventName(int evento) {
+    switch (evento) {
+    case PERF_CICLOS:
+        return "cycles";
+    case PERF_INSTRUCCIONES:
+        return "instructions";
+    case PERF_FALLOS_LLC:
+        return "llc_misses";
+    case PERF_FALLOS_RAMA:
+        return "branch_misses";
+    default:
+        return "desconocido";
+    }
+}
+
+PerfCounts& PerfCounts::operator+=(const PerfCounts& otro) {
+    for (int e = 0; e < PERF_EVENTOS; ++e) {
+        valores[e] += otro.valores[e];
+        valido[e] = valido[e] || otro.valido[e];
+    }
+    return *this;
+}
+
+bool PerfCounts::any() const {
+    return std::any_of(std::begin(valido), std::end(valido), [](bool v) { return v; });
+}
+
+double PerfCounts::ipc() const {
+    if (!valido[PERF_CICLOS] || !valido[PERF_INSTRUCCIONES] || valores[PERF_CICLOS] == 0) {
+        return -1.0;
+    }
+    return static_cast<double>(valores[PERF_INSTRUCCIONES]) / static_cast<double>(valores[PERF_CICLOS]);
+}
+
+PerfCounts PhasePerf::total() const {
+    PerfCounts suma;
+    for (const PerfCounts& h : hilos) {
+        suma += h;
+    }
+    return suma;
+}
+
+void PhasePerf::prepareBusy(std::size_t hilos_equipo) {
+    ocupado.assign(hilos_equipo, 0.0);
+}
+
+double PhasePerf::busyMax() const {
+    return ocupado.empty() ? -1.0 : *std::max_element(ocupado.begin(), ocupado.end());
+}
+
+double PhasePerf::busyMean() const {
+    if (ocupado.empty()) {
+        return -1.0;
+    }
+    double suma = 0.0;
+    for (double t : ocupado) {
+        suma += t;
+    }
+    return suma / static_cast<double>(ocupado.size());
+}
+
+double PhasePerf::idleFraction() const {
+    if (ocupado.empty() || pared <= 0.0) {
+        return -1.0;
+    }
+    return std::max(0.0, 1.0 - busyMean() / pared);
+}
+
+bool perfCountersAvailable() {
+    return contadores.read().any();
+}
+
+bool perfRequested() {
+    const char* valor = std::getenv("DBSCAN_PERF");
+    return valor != nullptr && *valor != '\0' && std::strcmp(valor, "0") != 0;
+}
+
+void perfBegin(PerfReport& perf) {
+    perf.ronda = siguiente_ronda.fetch_add(1);
+    clearPhase(perf.preparacion);
+    clearPhase(perf.conteo);
+    clearPhase(perf.cores);
+    clearPhase(perf.frontera);
+    const std::uint64_t ronda = perf.ronda;
+#pragma omp parallel
+    {
+        contadores.anterior = contadores.read();
+        contadores.ronda = ronda;
+    }
+}
+
+void perfLap(PerfReport& perf, PhasePerf& fase, double pared) {
+    fase.pared = pared;
+    fase.hilos.assign(static_cast<std::size_t>(omp_get_max_threads()), PerfCounts{});
+    const std::uint64_t ronda = perf.ronda;
+#pragma omp parallel
+    {
+        const std::size_t tid = static_cast<std::size_t>(omp_get_thread_num());
+        const PerfCounts actual = contadores.read();
+        if (contadores.ronda == ronda && tid < fase.hilos.size()) {
+            fase.hilos[tid] = difference(actual, contadores.anterior);
+        }
+        contadores.anterior = actual;
+        contadores.ronda = ronda;
+    }
+}
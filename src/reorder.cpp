@@ -0,0 +1,151 @@
+#include "reorder.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+using std::size_t;
+using std::uint32_t;
+
+const char* curveName(Curve curva) {
+    switch (curva) {
+    case Curve::Ninguna:
+        return "ninguna";
+    case Curve::Morton:
+        return "morton";
+    case Curve::Hilbert:
+        return "hilbert";
+    }
+    return "desconocida";
+}
+
+bool parseCurve(const std::string& nombre, Curve& curva) {
+    for (Curve candidata : {Curve::Ninguna, Curve::Morton, Curve::Hilbert}) {
+        if (nombre == curveName(candidata)) {
+            curva = candidata;
+            return true;
+        }
+    }
+    return false;
+}
+
+Curve curveRequested() {
+    const char* valor = std::getenv("DBSCAN_CURVE");
+    Curve curva = Curve::Ninguna;
+    if (valor != nullptr) {
+        parseCurve(valor, curva);
+    }
+    return curva;
+}
+
+namespace {
+
+// Separa los 16 bits bajos de v dejando un cero entre cada par.
+uint32_t spreadBits(uint32_t v) {
+    v &= 0x0000FFFFu;
+    v = (v | (v << 8)) & 0x00FF00FFu;
+    v = (v | (v << 4)) & 0x0F0F0F0Fu;
+    v = (v | (v << 2)) & 0x33333333u;
+    v = (v | (v << 1)) & 0x55555555u;
+    return v;
+}
+
+constexpr uint32_t LADO_CURVA = 1u << 16;
+
+}  // namespace
+
+uint32_t mortonKey(uint32_t x, uint32_t y) {
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+uint32_t hilbertKey(uint32_t x, uint32_t y) {
+    std::uint64_t d = 0;
+    for (uint32_t s = LADO_CURVA / 2; s > 0; s /= 2) {
+        const uint32_t rx = (x & s) > 0 ? 1u : 0u;
+        const uint32_t ry = (y & s) > 0 ? 1u : 0u;
+        d += static_cast<std::uint64_t>(s) * s * ((3u * rx) ^ ry);
+        // Rota el cuadrante para que la curva continúe en el siguiente nivel.
+        if (ry == 0) {
+            if (rx == 1) {
+                x = LADO_CURVA - 1 - x;
+                y = LADO_CURVA - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return static_cast<uint32_t>(d);
+}
+
+void buildSpatialOrder(const std::vector<Point>& puntos, Curve curva, SpatialOrder& orden) {
+    const size_t n = puntos.size();
+    orden.orden.resize(n);
+    if (curva == Curve::Ninguna || n == 0) {
+        for (size_t i = 0; i < n; ++i) {
+            orden.orden[i] = i;
+        }
+        return;
+    }
+
+    double min_x = puntos[0].x, max_x = puntos[0].x;
+    double min_y = puntos[0].y, max_y = puntos[0].y;
+#pragma omp parallel for schedule(static) reduction(min : min_x, min_y) reduction(max : max_x, max_y)
+    for (size_t i = 0; i < n; ++i) {
+        min_x = std::min(min_x, puntos[i].x);
+        max_x = std::max(max_x, puntos[i].x);
+        min_y = std::min(min_y, puntos[i].y);
+        max_y = std::max(max_y, puntos[i].y);
+    }
+    // La misma escala en ambos ejes conserva la forma de las celdas de la curva.
+    const double extension = std::max(max_x - min_x, max_y - min_y);
+    const double escala = extension > 0.0 ? (LADO_CURVA - 1) / extension : 0.0;
+
+    orden.claves.resize(n);
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t qx = static_cast<uint32_t>(std::clamp((puntos[i].x - min_x) * escala, 0.0, LADO_CURVA - 1.0));
+        const uint32_t qy = static_cast<uint32_t>(std::clamp((puntos[i].y - min_y) * escala, 0.0, LADO_CURVA - 1.0));
+        orden.claves[i] = curva == Curve::Hilbert ? hilbertKey(qx, qy) : mortonKey(qx, qy);
+        orden.orden[i] = i;
+    }
+
+    orden.claves_aux.resize(n);
+    orden.orden_aux.resize(n);
+    orden.histograma.assign(static_cast<size_t>(omp_get_max_threads()) * 256, 0);
+    for (int desplazamiento = 0; desplazamiento < 32; desplazamiento += 8) {
+#pragma omp parallel
+        {
+            const size_t hilos = static_cast<size_t>(omp_get_num_threads());
+            const size_t tid = static_cast<size_t>(omp_get_thread_num());
+            const size_t inicio = n * tid / hilos;
+            const size_t fin = n * (tid + 1) / hilos;
+            size_t* mio = &orden.histograma[tid * 256];
+            std::fill(mio, mio + 256, 0);
+            for (size_t i = inicio; i < fin; ++i) {
+                ++mio[(orden.claves[i] >> desplazamiento) & 0xFFu];
+            }
+#pragma omp barrier
+            // Posición de salida de cada (dígito, hilo): los hilos de un mismo dígito
+            // van en orden de tramo, lo que hace estable la pasada.
+#pragma omp single
+            {
+                size_t suma = 0;
+                for (size_t digito = 0; digito < 256; ++digito) {
+                    for (size_t t = 0; t < hilos; ++t) {
+                        const size_t cuenta = orden.histograma[t * 256 + digito];
+                        orden.histograma[t * 256 + digito] = suma;
+                        suma += cuenta;
+                    }
+                }
+            }
+            for (size_t i = inicio; i < fin; ++i) {
+                const size_t destino = mio[(orden.claves[i] >> desplazamiento) & 0xFFu]++;
+                orden.claves_aux[destino] = orden.claves[i];
+                orden.orden_aux[destino] = orden.orden[i];
+            }
+        }
+        orden.claves.swap(orden.claves_aux);
+        orden.orden.swap(orden.orden_aux);
+    }
+}
@@ -1,53 +1,32 @@
 #include "dbscan.hpp"
+#include "clusterer.hpp"
+#include "io.hpp"
+#include "pair_count.hpp"
+#include "soa.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <vector>
 
 using std::size_t;
 
 std::vector<Point> loadPoints(const std::string& archivo) {
-    std::ifstream in(archivo);
-    if (!in) {
+    if (isBinaryPath(archivo)) {
+        return loadPointsBinary(archivo);
+    }
+    const MappedFile mapa(archivo);
+    if (!mapa.ok()) {
         std::cerr << "Error: no se pudo abrir " << archivo << std::endl;
         return {};
     }
-
-    std::vector<Point> puntos;
-    const auto nombre = archivo.substr(archivo.find_last_of("/\\") + 1);
-    const auto subrayado = nombre.find('_');
-    if (subrayado != std::string::npos) {
-        try {
-            size_t estimado = static_cast<size_t>(std::stoul(nombre.substr(0, subrayado)));
-            puntos.reserve(estimado);
-        } catch (const std::exception&) {
-            // Continuamos sin reservar si no coincide el formato.
-        }
-    }
-
-    std::string linea;
-    while (std::getline(in, linea)) {
-        if (linea.empty()) {
-            continue;
-        }
-
-        std::stringstream ss(linea);
-        Point p;
-        char coma;
-        if (ss >> p.x >> coma >> p.y) {
-            puntos.push_back(p);
-        }
-    }
-
-    return puntos;
+    return parsePointsCSV(mapa.data(), mapa.size());
 }
 
 double distanceSquared(const Point& a, const Point& b) {
-    const double dx = a.x - b.x;
-    const double dy = a.y - b.y;
-    return dx * dx + dy * dy;
+    return squaredNorm(a.x - b.x, a.y - b.y);
 }
 
 std::string writeResultsCSV(const std::vector<Point>& puntos, 
@@ -60,60 +39,166 @@ std::string writeResultsCSV(const std::vector<Point>& puntos,
 
     const std::string archivo =
         output_dir + "/" + std::to_string(puntos.size()) + "_results_" + etiqueta + ".csv";
-    std::ofstream out(archivo);
-    if (!out) {
-        std::cerr << "Error: no se pudo escribir " << archivo << std::endl;
-        return "";
+    return writePointsCSV(puntos, archivo, true) ? archivo : "";
+}
+
+void resetLabels(std::vector<Point>& puntos) {
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < puntos.size(); ++i) {
+        puntos[i].label = NOISE;
+        puntos[i].cluster = NOISE;
     }
+}
 
-    out << "x,y,label\n";
-    for (const auto& p : puntos) {
-        out << p.x << ',' << p.y << ',' << p.label << '\n';
+bool prepareNeighborLists(Workspace& ws, size_t n, int min_samples) {
+    ws.capacidad = min_samples > 1 ? static_cast<size_t>(min_samples - 1) : 0;
+    ws.usa_lista = n * ws.capacidad <= LISTA_VECINOS_MAX;
+    if (ws.usa_lista) {
+        firstTouchResize(ws.lista, n * ws.capacidad);
     }
+    return ws.usa_lista;
+}
 
-    return archivo;
+int* preparePrivateCounts(Workspace& ws, size_t n, size_t hilos) {
+    ws.hilos_privados = 0;
+    if (hilos * n > CONTEOS_PRIVADOS_MAX) {
+        return nullptr;
+    }
+    // Sin inicializar al crecer: cada hilo toca primero su propio arreglo al limpiarlo.
+    if (ws.privados.size() < hilos * n) {
+        firstTouchResize(ws.privados, hilos * n);
+    }
+    int* privados = ws.privados.data();
+#pragma omp parallel for schedule(static, 1)
+    for (size_t t = 0; t < hilos; ++t) {
+        std::fill(privados + t * n, privados + (t + 1) * n, 0);
+    }
+    ws.hilos_privados = hilos;
+    return privados;
 }
 
-std::vector<Point> dbscan_serial(const std::string& ruta, 
-                                 double epsilon, 
-                                 int min_samples) {
-    std::vector<Point> puntos = loadPoints(ruta);
+void reducePrivateCounts(Workspace& ws, size_t n) {
+    const int* privados = ws.privados.data();
+    const size_t hilos = ws.hilos_privados;
+    int* vecinos = ws.vecinos.data();
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        int total = 0;
+        for (size_t t = 0; t < hilos; ++t) {
+            total += privados[t * n + i];
+        }
+        vecinos[i] = total;
+    }
+}
+
+void assignBordersFromLists(std::vector<Point>& puntos, const Workspace& ws, bool paralelo) {
+    const size_t n = puntos.size();
+#pragma omp parallel for schedule(static) if (paralelo)
+    for (size_t i = 0; i < n; ++i) {
+        if (puntos[i].label != NOISE) {
+            continue;
+        }
+        if (listedNeighborIsCore(ws, i, [&](size_t j) { return puntos[j].label == CORE1; })) {
+            puntos[i].label = CORE2;
+        }
+    }
+}
+
+void assignBorders(std::vector<Point>& puntos, Workspace& ws, double eps2, bool paralelo) {
+    if (ws.usa_lista) {
+        assignBordersFromLists(puntos, ws, paralelo);
+        return;
+    }
+
+    const size_t n = puntos.size();
+    const PointsSoA& soa = ws.soa;
+    PointsSoA& cores = ws.cores;
+    cores.assignCores(puntos);
+#pragma omp parallel for schedule(static) if (paralelo)
+    for (size_t i = 0; i < n; ++i) {
+        if (puntos[i].label != NOISE) {
+            continue;
+        }
+        if (anyWithin(soa.x[i], soa.y[i], cores.x.data(), cores.y.data(), cores.size(), eps2)) {
+            puntos[i].label = CORE2;
+        }
+    }
+}
+
+void dbscan_serial(std::vector<Point>& puntos,
+                   double epsilon,
+                   int min_samples,
+                   Workspace& ws) {
+    PhaseClock reloj(ws.perf);
+    ws.fases = PhaseTimes{};
+    resetLabels(puntos);
     const size_t n = puntos.size();
     if (n == 0) {
-        return puntos;
+        return;
     }
 
     const double eps2 = epsilon * epsilon;
-    std::vector<int> vecinos(n, 0);
-
+    FirstTouchVector<int>& vecinos = ws.vecinos;
+    firstTouchAssign(vecinos, n, 0);
+    PointsSoA& soa = ws.soa;
+    soa.assign(puntos);
+    const bool usa_lista = prepareNeighborLists(ws, n, min_samples);
+    const size_t cap = ws.capacidad;
+    int* lista = ws.lista.data();
+
+    ws.fases.preparacion = reloj.lap(ws.perf.preparacion);
+
+    // Cada fila i se compara contra bloques de hasta 64 candidatos j > i; el bit k de
+    // la máscara indica que el candidato j0 + k es vecino. El contador previo de cada
+    // punto es la posición libre en su lista de vecinos.
     for (size_t i = 0; i < n; ++i) {
-        for (size_t j = i + 1; j < n; ++j) {
-            if (distanceSquared(puntos[i], puntos[j]) <= eps2) {
-                ++vecinos[i];
+        for (size_t j0 = i + 1; j0 < n; j0 += 64) {
+            const size_t len = std::min<size_t>(64, n - j0);
+            std::uint64_t mask = maskWithin(soa.x[i], soa.y[i], &soa.x[j0], &soa.y[j0], len, eps2);
+            if (!usa_lista) {
+                vecinos[i] += popcount64(mask);
+            }
+            while (mask != 0) {
+                const size_t j = j0 + lowestBit64(mask);
+                if (usa_lista) {
+                    const size_t slot_i = static_cast<size_t>(vecinos[i]++);
+                    if (slot_i < cap) {
+                        lista[i * cap + slot_i] = static_cast<int>(j);
+                    }
+                    const size_t slot_j = static_cast<size_t>(vecinos[j]);
+                    if (slot_j < cap) {
+                        lista[j * cap + slot_j] = static_cast<int>(i);
+                    }
+                }
                 ++vecinos[j];
+                mask &= mask - 1;
             }
         }
     }
 
+    ws.fases.conteo = reloj.lap(ws.perf.conteo);
+    if (ws.perf.activo) {
+        ws.perf.conteo.ocupado.assign(1, ws.fases.conteo);  // un solo hilo, sin ocio
+    }
+    ws.fases.pares = static_cast<double>(n) * static_cast<double>(n - 1) / 2.0;
+
     for (size_t i = 0; i < n; ++i) {
         if (vecinos[i] >= min_samples) {
             puntos[i].label = CORE1;
         }
     }
 
-    for (size_t i = 0; i < n; ++i) {
-        if (puntos[i].label != NOISE) {
-            continue;
-        }
-        for (size_t j = 0; j < n; ++j) {
-            if (puntos[j].label == CORE1 &&
-                distanceSquared(puntos[i], puntos[j]) <= eps2) {
-                puntos[i].label = CORE2;
-                break;
-            }
-        }
-    }
+    ws.fases.cores = reloj.lap(ws.perf.cores);
 
-    return puntos;
+    assignBorders(puntos, ws, eps2, false);
+    ws.fases.frontera = reloj.lap(ws.perf.frontera);
 }
 
+std::vector<Point> dbscan_serial(const std::string& ruta, 
+                                 double epsilon, 
+                                 int min_samples) {
+    std::vector<Point> puntos = loadPoints(ruta);
+    Workspace ws;
+    dbscan_serial(puntos, epsilon, min_samples, ws);
+    return puntos;
+}
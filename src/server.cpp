@@ -0,0 +1,333 @@
+#include "server.hpp"
+#include "io.hpp"
+
+#include <omp.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+using std::size_t;
+
+namespace {
+
+std::int64_t modificationTime(const std::string& ruta) {
+    std::error_code error;
+    const auto marca = std::filesystem::last_write_time(ruta, error);
+    return error ? -1 : static_cast<std::int64_t>(marca.time_since_epoch().count());
+}
+
+bool sendAll(int fd, const std::string& texto) {
+    const char* p = texto.data();
+    size_t pendiente = texto.size();
+    while (pendiente > 0) {
+        // MSG_NOSIGNAL: un cliente que se va antes de leer no termina el servidor.
+        const ssize_t enviados = ::send(fd, p, pendiente, MSG_NOSIGNAL);
+        if (enviados <= 0) {
+            if (enviados < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += enviados;
+        pendiente -= static_cast<size_t>(enviados);
+    }
+    return true;
+}
+
+// Llama f(línea) con cada línea completa que llega por fd hasta EOF o hasta que f
+// devuelva false.
+template <typename F>
+void forEachLine(int fd, F&& f) {
+    std::string resto;
+    char buffer[4096];
+    while (true) {
+        const ssize_t leidos = ::read(fd, buffer, sizeof(buffer));
+        if (leidos < 0 && errno == EINTR) {
+            continue;
+        }
+        if (leidos <= 0) {
+            break;
+        }
+        resto.append(buffer, static_cast<size_t>(leidos));
+        size_t inicio = 0;
+        for (size_t fin; (fin = resto.find('\n', inicio)) != std::string::npos; inicio = fin + 1) {
+            if (!f(resto.substr(inicio, fin - inicio))) {
+                return;
+            }
+        }
+        resto.erase(0, inicio);
+    }
+    if (!resto.empty()) {
+        f(resto);
+    }
+}
+
+bool socketAddress(const std::string& ruta, sockaddr_un& direccion) {
+    std::memset(&direccion, 0, sizeof(direccion));
+    direccion.sun_family = AF_UNIX;
+    if (ruta.empty() || ruta.size() >= sizeof(direccion.sun_path)) {
+        return false;
+    }
+    std::memcpy(direccion.sun_path, ruta.c_str(), ruta.size() + 1);
+    return true;
+}
+
+}  // namespace
+
+std::vector<Point> CachedDataset::inFileOrder() const {
+    std::vector<Point> salida(puntos.size());
+#pragma omp parallel for schedule(static)
+    for (size_t k = 0; k < puntos.size(); ++k) {
+        salida[orden[k]] = puntos[k];
+    }
+    return salida;
+}
+
+DatasetCache::DatasetCache(std::size_t memoria, Curve curva) : memoria_(memoria), curva_(curva) {}
+
+CachedDataset* DatasetCache::acquire(const std::string& ruta, bool& acierto) {
+    acierto = false;
+    const std::int64_t modificado = modificationTime(ruta);
+    const auto encontrado = indice_.find(ruta);
+    if (encontrado != indice_.end()) {
+        if ((*encontrado->second)->modificado == modificado) {
+            lru_.splice(lru_.begin(), lru_, encontrado->second);
+            acierto = true;
+            return lru_.front().get();
+        }
+        drop(ruta);
+    }
+
+    std::vector<Point> leidos = loadPoints(ruta);
+    if (leidos.empty()) {
+        return nullptr;
+    }
+    auto conjunto = std::make_unique<CachedDataset>();
+    conjunto->ruta = ruta;
+    conjunto->modificado = modificado;
+    {
+        // El orden espacial se calcula una vez por conjunto y lo aprovechan todas las
+        // solicitudes; los buffers del radix sort se liberan al salir.
+        SpatialOrder curva;
+        buildSpatialOrder(leidos, curva_, curva);
+        conjunto->orden = std::move(curva.orden);
+    }
+    const size_t n = leidos.size();
+    conjunto->puntos.resize(n);
+#pragma omp parallel for schedule(static)
+    for (size_t k = 0; k < n; ++k) {
+        conjunto->puntos[k] = leidos[conjunto->orden[k]];
+    }
+    conjunto->bytes = n * SERVER_BYTES_POR_PUNTO;
+
+    bytes_ += conjunto->bytes;
+    lru_.push_front(std::move(conjunto));
+    indice_[ruta] = lru_.begin();
+    evict();
+    return lru_.front().get();
+}
+
+bool DatasetCache::drop(const std::string& ruta) {
+    const auto encontrado = indice_.find(ruta);
+    if (encontrado == indice_.end()) {
+        return false;
+    }
+    bytes_ -= (*encontrado->second)->bytes;
+    lru_.erase(encontrado->second);
+    indice_.erase(encontrado);
+    return true;
+}
+
+void DatasetCache::evict() {
+    while (bytes_ > memoria_ && lru_.size() > 1) {
+        drop(lru_.back()->ruta);
+    }
+}
+
+void DatasetCache::describe(std::ostream& out) const {
+    for (const auto& conjunto : lru_) {
+        out << "  " << conjunto->ruta << ": " << conjunto->puntos.size() << " puntos, "
+            << (conjunto->bytes >> 20) << " MB, " << conjunto->usos << " usos\n";
+    }
+}
+
+DBSCANServer::DBSCANServer(const ServerOptions& opciones)
+    : opciones_(opciones), cache_(opciones.memoria, opciones.curva) {}
+
+std::string DBSCANServer::handle(const std::string& linea) {
+    std::istringstream entrada(linea);
+    std::string comando;
+    entrada >> comando;
+    std::ostringstream respuesta;
+    respuesta << std::fixed << std::setprecision(6);
+
+    if (comando.empty()) {
+        return "error solicitud vacía";
+    }
+    if (comando == "shutdown") {
+        activo_ = false;
+        return "ok";
+    }
+    if (comando == "stats") {
+        respuesta << "ok conjuntos=" << cache_.size() << " bytes=" << cache_.bytes()
+                  << " presupuesto=" << cache_.budget() << " solicitudes=" << solicitudes_
+                  << " aciertos=" << aciertos_;
+        return respuesta.str();
+    }
+
+    std::string ruta;
+    if (!(entrada >> ruta)) {
+        return "error falta la ruta";
+    }
+    if (comando == "drop") {
+        return cache_.drop(ruta) ? "ok" : "error " + ruta + " no está en el cache";
+    }
+    if (comando != "load" && comando != "cluster") {
+        return "error comando desconocido: " + comando;
+    }
+
+    double epsilon = 0.0;
+    int min_samples = 0;
+    std::string motor;
+    std::string salida;
+    Engine engine = opciones_.engine;
+    if (comando == "cluster") {
+        if (!(entrada >> epsilon >> min_samples)) {
+            return "error uso: cluster <ruta> <eps> <min_samples> [motor] [salida]";
+        }
+        if (entrada >> motor && !parseEngine(motor, engine)) {
+            return "error motor desconocido: " + motor;
+        }
+        entrada >> salida;
+    }
+
+    ++solicitudes_;
+    const double inicio = omp_get_wtime();
+    bool acierto = false;
+    CachedDataset* conjunto = cache_.acquire(ruta, acierto);
+    if (conjunto == nullptr) {
+        return "error no se pudieron cargar puntos desde " + ruta;
+    }
+    aciertos_ += acierto ? 1 : 0;
+    ++conjunto->usos;
+    const size_t n = conjunto->puntos.size();
+    if (comando == "load") {
+        respuesta << "ok puntos=" << n << " bytes=" << conjunto->bytes << " cache=" << (acierto ? "hit" : "miss")
+                  << " segundos=" << omp_get_wtime() - inicio;
+        return respuesta.str();
+    }
+
+    Clusterer& clusterer = conjunto->clusterer;
+    clusterer.setEngine(engine);
+    clusterer.setThreads(opciones_.num_threads);
+    clusterer.run(conjunto->puntos, epsilon, min_samples);
+    size_t cores = 0;
+    size_t frontera = 0;
+#pragma omp parallel for schedule(static) reduction(+ : cores, frontera)
+    for (size_t k = 0; k < n; ++k) {
+        cores += conjunto->puntos[k].label == CORE1;
+        frontera += conjunto->puntos[k].label == CORE2;
+    }
+    const double tiempo = omp_get_wtime() - inicio;
+
+    respuesta << "ok puntos=" << n << " cores=" << cores << " frontera=" << frontera
+              << " ruido=" << n - cores - frontera << " segundos=" << tiempo
+              << " cache=" << (acierto ? "hit" : "miss");
+    if (!salida.empty()) {
+        // Los IDs se numeran en el orden del archivo, como en --clusters, y quedan en
+        // el cache junto con las etiquetas.
+        std::vector<Point> ordenados = conjunto->inFileOrder();
+        assignClusters(ordenados, epsilon, opciones_.num_threads);
+        int clusters = 0;
+#pragma omp parallel for schedule(static) reduction(max : clusters)
+        for (size_t k = 0; k < n; ++k) {
+            conjunto->puntos[k].cluster = ordenados[conjunto->orden[k]].cluster;
+            clusters = std::max(clusters, conjunto->puntos[k].cluster + 1);
+        }
+        const bool escrito = isBinaryPath(salida) ? writeLabelsBinary(ordenados, salida)
+                                                  : writePointsCSV(ordenados, salida, false);
+        if (!escrito) {
+            return "error no se pudo escribir " + salida;
+        }
+        respuesta << " clusters=" << clusters << " salida=" << salida;
+    }
+    return respuesta.str();
+}
+
+bool DBSCANServer::serve(std::ostream& registro) {
+    sockaddr_un direccion;
+    if (!socketAddress(opciones_.socket, direccion)) {
+        registro << "Ruta de socket inválida: " << opciones_.socket << '\n';
+        return false;
+    }
+    const int servidor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (servidor < 0) {
+        registro << "No se pudo crear el socket: " << std::strerror(errno) << '\n';
+        return false;
+    }
+    ::unlink(opciones_.socket.c_str());
+    if (::bind(servidor, reinterpret_cast<const sockaddr*>(&direccion), sizeof(direccion)) != 0 ||
+        ::listen(servidor, 16) != 0) {
+        registro << "No se pudo escuchar en " << opciones_.socket << ": " << std::strerror(errno) << '\n';
+        ::close(servidor);
+        return false;
+    }
+
+    while (activo_) {
+        const int cliente = ::accept(servidor, nullptr, nullptr);
+        if (cliente < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            registro << "accept falló: " << std::strerror(errno) << '\n';
+            break;
+        }
+        forEachLine(cliente, [&](const std::string& linea) {
+            const std::string respuesta = handle(linea);
+            registro << "> " << linea << "\n< " << respuesta << '\n' << std::flush;
+            return sendAll(cliente, respuesta + '\n') && activo_;
+        });
+        ::close(cliente);
+    }
+    ::close(servidor);
+    ::unlink(opciones_.socket.c_str());
+    return true;
+}
+
+bool sendRequests(const std::string& socket, const std::vector<std::string>& lineas, std::vector<std::string>& respuestas) {
+    sockaddr_un direccion;
+    if (!socketAddress(socket, direccion)) {
+        return false;
+    }
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&direccion), sizeof(direccion)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    std::string texto;
+    for (const auto& linea : lineas) {
+        texto += linea;
+        texto += '\n';
+    }
+    const bool enviado = sendAll(fd, texto);
+    ::shutdown(fd, SHUT_WR);
+    if (enviado) {
+        forEachLine(fd, [&](const std::string& linea) {
+            respuestas.push_back(linea);
+            return true;
+        });
+    }
+    ::close(fd);
+    return enviado;
+}
@@ -0,0 +1,213 @@
+#include "soa.hpp"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using std::size_t;
+using std::uint64_t;
+
+void PointsSoA::assign(const std::vector<Point>& puntos) {
+    const size_t n = puntos.size();
+    x.resize(n);
+    y.resize(n);
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = puntos[i].x;
+        y[i] = puntos[i].y;
+    }
+}
+
+void PointsSoA::assignCores(const std::vector<Point>& puntos) {
+    x.clear();
+    y.clear();
+    for (const auto& p : puntos) {
+        if (p.label == CORE1) {
+            x.push_back(p.x);
+            y.push_back(p.y);
+        }
+    }
+}
+
+void blockBoxes(const PointsSoA& soa, size_t block_size, std::vector<Caja>& cajas) {
+    const size_t n = soa.size();
+    const size_t block_count = (n + block_size - 1) / block_size;
+    cajas.resize(block_count);
+#pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < block_count; ++b) {
+        const size_t inicio = b * block_size;
+        const size_t fin = std::min(n, inicio + block_size);
+        Caja caja{soa.x[inicio], soa.x[inicio], soa.y[inicio], soa.y[inicio]};
+        for (size_t i = inicio + 1; i < fin; ++i) {
+            caja.min_x = std::min(caja.min_x, soa.x[i]);
+            caja.max_x = std::max(caja.max_x, soa.x[i]);
+            caja.min_y = std::min(caja.min_y, soa.y[i]);
+            caja.max_y = std::max(caja.max_y, soa.y[i]);
+        }
+        cajas[b] = caja;
+    }
+}
+
+#if defined(__AVX512F__)
+
+namespace {
+
+inline __mmask8 compare8(__m512d vx, __m512d vy, __m512d ve, const double* xs, const double* ys, __mmask8 activos) {
+    const __m512d dx = _mm512_sub_pd(vx, _mm512_maskz_loadu_pd(activos, xs));
+    const __m512d dy = _mm512_sub_pd(vy, _mm512_maskz_loadu_pd(activos, ys));
+#ifdef __FMA__
+    const __m512d d2 = _mm512_fmadd_pd(dx, dx, _mm512_mul_pd(dy, dy));
+#else
+    const __m512d d2 = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+#endif
+    return _mm512_mask_cmp_pd_mask(activos, d2, ve, _CMP_LE_OQ);
+}
+
+inline __mmask8 tailMask(size_t restantes) {
+    return static_cast<__mmask8>(restantes >= 8 ? 0xFF : (1u << restantes) - 1);
+}
+
+}
+
+uint64_t maskWithin(double px, double py, const double* xs, const double* ys, size_t count, double eps2) {
+    const __m512d vx = _mm512_set1_pd(px);
+    const __m512d vy = _mm512_set1_pd(py);
+    const __m512d ve = _mm512_set1_pd(eps2);
+    uint64_t mask = 0;
+    for (size_t k = 0; k < count; k += 8) {
+        const __mmask8 m = compare8(vx, vy, ve, xs + k, ys + k, tailMask(count - k));
+        mask |= static_cast<uint64_t>(m) << k;
+    }
+    return mask;
+}
+
+size_t countWithin(double px, double py, const double* xs, const double* ys, size_t count, double eps2) {
+    const __m512d vx = _mm512_set1_pd(px);
+    const __m512d vy = _mm512_set1_pd(py);
+    const __m512d ve = _mm512_set1_pd(eps2);
+    size_t total = 0;
+    for (size_t k = 0; k < count; k += 8) {
+        total += popcount64(compare8(vx, vy, ve, xs + k, ys + k, tailMask(count - k)));
+    }
+    return total;
+}
+
+bool anyWithin(double px, double py, const double* xs, const double* ys, size_t count, double eps2) {
+    const __m512d vx = _mm512_set1_pd(px);
+    const __m512d vy = _mm512_set1_pd(py);
+    const __m512d ve = _mm512_set1_pd(eps2);
+    for (size_t k = 0; k < count; k += 8) {
+        if (compare8(vx, vy, ve, xs + k, ys + k, tailMask(count - k)) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* simdKernelName() {
+    return "avx512";
+}
+
+#elif defined(__AVX2__)
+
+namespace {
+
+inline int compare4(__m256d vx, __m256d vy, __m256d ve, const double* xs, const double* ys) {
+    const __m256d dx = _mm256_sub_pd(vx, _mm256_loadu_pd(xs));
+    const __m256d dy = _mm256_sub_pd(vy, _mm256_loadu_pd(ys));
+#ifdef __FMA__
+    const __m256d d2 = _mm256_fmadd_pd(dx, dx, _mm256_mul_pd(dy, dy));
+#else
+    const __m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+#endif
+    return _mm256_movemask_pd(_mm256_cmp_pd(d2, ve, _CMP_LE_OQ));
+}
+
+}
+
+uint64_t maskWithin(double px, double py, const double* xs, const double* ys, size_t count, double eps2) {
+    const __m256d vx = _mm256_set1_pd(px);
+    const __m256d vy = _mm256_set1_pd(py);
+    const __m256d ve = _mm256_set1_pd(eps2);
+    uint64_t mask = 0;
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        mask |= static_cast<uint64_t>(compare4(vx, vy, ve, xs + k, ys + k)) << k;
+    }
+    for (; k < count; ++k) {
+        if (squaredNorm(px - xs[k], py - ys[k]) <= eps2) {
+            mask |= uint64_t{1} << k;
+        }
+    }
+    return mask;
+}
+
+size_t countWithin(double px, double py, const double* xs, const double* ys, size_t count, double eps2) {
+    const __m256d vx = _mm256_set1_pd(px);
+    const __m256d vy = _mm256_set1_pd(py);
+    const __m256d ve = _mm256_set1_pd(eps2);
+    size_t total = 0;
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        total += popcount64(static_cast<uint64_t>(compare4(vx, vy, ve, xs + k, ys + k)));
+    }
+    for (; k < count; ++k) {
+        total += squaredNorm(px - xs[k], py - ys[k]) <= eps2;
+    }
+    return total;
+}
+
+bool anyWithin(double px, double py, const double* xs, const double* ys, size_t count, double eps2) {
+    const __m256d vx = _mm256_set1_pd(px);
+    const __m256d vy = _mm256_set1_pd(py);
+    const __m256d ve = _mm256_set1_pd(eps2);
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        if (compare4(vx, vy, ve, xs + k, ys + k) != 0) {
+            return true;
+        }
+    }
+    for (; k < count; ++k) {
+        if (squaredNorm(px - xs[k], py - ys[k]) <= eps2) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* simdKernelName() {
+    return "avx2";
+}
+
+#else
+
+uint64_t maskWithin(double px, double py, const double* xs, const double* ys, size_t count, double eps2) {
+    uint64_t mask = 0;
+    for (size_t k = 0; k < count; ++k) {
+        mask |= static_cast<uint64_t>(squaredNorm(px - xs[k], py - ys[k]) <= eps2) << k;
+    }
+    return mask;
+}
+
+size_t countWithin(double px, double py, const double* xs, const double* ys, size_t count, double eps2) {
+    size_t total = 0;
+    for (size_t k = 0; k < count; ++k) {
+        total += squaredNorm(px - xs[k], py - ys[k]) <= eps2;
+    }
+    return total;
+}
+
+bool anyWithin(double px, double py, const double* xs, const double* ys, size_t count, double eps2) {
+    for (size_t k = 0; k < count; ++k) {
+        if (squaredNorm(px - xs[k], py - ys[k]) <= eps2) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* simdKernelName() {
+    return "escalar";
+}
+
+#endif
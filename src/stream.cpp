@@ -0,0 +1,239 @@
+#include "stream.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using std::size_t;
+
+namespace {
+
+// Marca id como tocado; devuelve true solo para el primer hilo que lo marca.
+bool markTouched(std::vector<char>& tocados, size_t pos) {
+    char previo;
+#pragma omp atomic capture
+    { previo = tocados[pos]; tocados[pos] = 1; }
+    return previo == 0;
+}
+
+}
+
+StreamingDBSCAN::StreamingDBSCAN(double epsilon, int min_samples, size_t ventana)
+    : eps2_(epsilon * epsilon),
+      cell_(epsilon > 0.0 ? epsilon * (1.0 + 1e-9) : 1.0),
+      min_samples_(min_samples),
+      ventana_(ventana) {}
+
+std::uint64_t StreamingDBSCAN::cellKey(double x, double y) const {
+    const auto cx = static_cast<std::int64_t>(std::floor(x / cell_));
+    const auto cy = static_cast<std::int64_t>(std::floor(y / cell_));
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+           static_cast<std::uint32_t>(cy);
+}
+
+template <typename F>
+void StreamingDBSCAN::forEachCandidate(double x, double y, F&& f) const {
+    const auto cx = static_cast<std::int64_t>(std::floor(x / cell_));
+    const auto cy = static_cast<std::int64_t>(std::floor(y / cell_));
+    for (std::int64_t dx = -1; dx <= 1; ++dx) {
+        for (std::int64_t dy = -1; dy <= 1; ++dy) {
+            const std::uint64_t clave =
+                (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx + dx)) << 32) |
+                static_cast<std::uint32_t>(cy + dy);
+            const auto it = celdas_.find(clave);
+            if (it == celdas_.end()) {
+                continue;
+            }
+            for (size_t id : it->second) {
+                f(id);
+            }
+        }
+    }
+}
+
+StreamingDBSCAN::Cambios StreamingDBSCAN::insert(const std::vector<Point>& lote) {
+    Cambios cambios;
+    // Con ventana, los puntos del lote que no caben expirarían de inmediato.
+    size_t primero = 0;
+    if (ventana_ > 0 && lote.size() > ventana_) {
+        primero = lote.size() - ventana_;
+    }
+    const size_t nuevos = lote.size() - primero;
+    if (ventana_ > 0 && size() + nuevos > ventana_) {
+        cambios = expireOldest(size() + nuevos - ventana_);
+    }
+    cambios.insertados = lote.size();
+    cambios.expirados += primero;
+    if (nuevos == 0) {
+        return cambios;
+    }
+
+    const size_t id_inicio = base_ + puntos_.size();
+    for (size_t k = primero; k < lote.size(); ++k) {
+        Point p = lote[k];
+        p.label = NOISE;
+        p.cluster = NOISE;
+        puntos_.push_back(p);
+        vecinos_.push_back(0);
+        tocados_.push_back(1);
+        celdas_[cellKey(p.x, p.y)].push_back(base_ + puntos_.size() - 1);
+    }
+    ruido_ += nuevos;
+
+    // Cada punto nuevo cuenta sus vecinos; los pares nuevo-nuevo se cuentan desde
+    // ambos lados y los puntos viejos se incrementan con atómicos.
+    std::vector<size_t> afectados;
+    afectados.reserve(nuevos);
+    for (size_t id = id_inicio; id < id_inicio + nuevos; ++id) {
+        afectados.push_back(id);
+    }
+#pragma omp parallel
+    {
+        std::vector<size_t> local;
+#pragma omp for schedule(dynamic, 64)
+        for (size_t k = 0; k < nuevos; ++k) {
+            const size_t id = id_inicio + k;
+            const Point& p = at(id);
+            int cuenta = 0;
+            forEachCandidate(p.x, p.y, [&](size_t j) {
+                if (j == id || distanceSquared(p, at(j)) > eps2_) {
+                    return;
+                }
+                ++cuenta;
+                if (j < id_inicio) {
+#pragma omp atomic
+                    ++vecinos_[j - base_];
+                    if (markTouched(tocados_, j - base_)) {
+                        local.push_back(j);
+                    }
+                }
+            });
+            vecinos_[id - base_] = cuenta;
+        }
+#pragma omp critical
+        afectados.insert(afectados.end(), local.begin(), local.end());
+    }
+
+    cambios.reetiquetados = relabel(afectados);
+    return cambios;
+}
+
+StreamingDBSCAN::Cambios StreamingDBSCAN::expireOldest(size_t cuantos) {
+    Cambios cambios;
+    cuantos = std::min(cuantos, size());
+    if (cuantos == 0) {
+        return cambios;
+    }
+
+    // Los ids de cada celda están en orden de llegada: el más viejo va al frente.
+    const size_t id_inicio = base_ + inicio_;
+    for (size_t id = id_inicio; id < id_inicio + cuantos; ++id) {
+        const Point& p = at(id);
+        const auto it = celdas_.find(cellKey(p.x, p.y));
+        std::vector<size_t>& ids = it->second;
+        ids.erase(std::find(ids.begin(), ids.end(), id));
+        if (ids.empty()) {
+            celdas_.erase(it);
+        }
+        cores_ -= p.label == CORE1;
+        ruido_ -= p.label == NOISE;
+    }
+    inicio_ += cuantos;
+    cambios.expirados = cuantos;
+
+    std::vector<size_t> afectados;
+#pragma omp parallel
+    {
+        std::vector<size_t> local;
+#pragma omp for schedule(dynamic, 64)
+        for (size_t id = id_inicio; id < id_inicio + cuantos; ++id) {
+            const Point& p = at(id);
+            forEachCandidate(p.x, p.y, [&](size_t j) {
+                if (distanceSquared(p, at(j)) > eps2_) {
+                    return;
+                }
+#pragma omp atomic
+                --vecinos_[j - base_];
+                if (markTouched(tocados_, j - base_)) {
+                    local.push_back(j);
+                }
+            });
+        }
+#pragma omp critical
+        afectados.insert(afectados.end(), local.begin(), local.end());
+    }
+    cambios.reetiquetados = relabel(afectados);
+
+    // Compacta cuando los expirados ocupan más de la mitad de los arreglos.
+    if (inicio_ >= 1024 && inicio_ * 2 >= puntos_.size()) {
+        const auto corte = static_cast<std::ptrdiff_t>(inicio_);
+        puntos_.erase(puntos_.begin(), puntos_.begin() + corte);
+        vecinos_.erase(vecinos_.begin(), vecinos_.begin() + corte);
+        tocados_.erase(tocados_.begin(), tocados_.begin() + corte);
+        base_ += inicio_;
+        inicio_ = 0;
+    }
+    return cambios;
+}
+
+size_t StreamingDBSCAN::relabel(std::vector<size_t>& afectados) {
+    const int min_samples = min_samples_;
+    auto esCore = [&](size_t id) { return vecinos_[id - base_] >= min_samples; };
+
+    // Un punto que entra o sale de core cambia la frontera de todo su vecindario.
+    const size_t directos = afectados.size();
+#pragma omp parallel
+    {
+        std::vector<size_t> local;
+#pragma omp for schedule(dynamic, 64)
+        for (size_t k = 0; k < directos; ++k) {
+            const size_t id = afectados[k];
+            if (esCore(id) == (at(id).label == CORE1)) {
+                continue;
+            }
+            const Point& p = at(id);
+            forEachCandidate(p.x, p.y, [&](size_t j) {
+                if (distanceSquared(p, at(j)) <= eps2_ && markTouched(tocados_, j - base_)) {
+                    local.push_back(j);
+                }
+            });
+        }
+#pragma omp critical
+        afectados.insert(afectados.end(), local.begin(), local.end());
+    }
+
+    // Las etiquetas nuevas dependen solo de los conteos, no del orden de revisión.
+    long delta_cores = 0;
+    long delta_ruido = 0;
+    const size_t total = afectados.size();
+#pragma omp parallel for schedule(dynamic, 64) reduction(+ : delta_cores, delta_ruido)
+    for (size_t k = 0; k < total; ++k) {
+        const size_t id = afectados[k];
+        const Point& p = at(id);
+        int nueva = NOISE;
+        if (esCore(id)) {
+            nueva = CORE1;
+        } else {
+            bool frontera = false;
+            forEachCandidate(p.x, p.y, [&](size_t j) {
+                frontera = frontera || (esCore(j) && distanceSquared(p, at(j)) <= eps2_);
+            });
+            nueva = frontera ? CORE2 : NOISE;
+        }
+        const int anterior = p.label;
+        delta_cores += (nueva == CORE1) - (anterior == CORE1);
+        delta_ruido += (nueva == NOISE) - (anterior == NOISE);
+        at(id).label = nueva;
+        tocados_[id - base_] = 0;
+    }
+    cores_ = static_cast<size_t>(static_cast<long>(cores_) + delta_cores);
+    ruido_ = static_cast<size_t>(static_cast<long>(ruido_) + delta_ruido);
+    return total;
+}
+
+std::vector<Point> StreamingDBSCAN::snapshot() const {
+    return std::vector<Point>(puntos_.begin() + static_cast<std::ptrdiff_t>(inicio_), puntos_.end());
+}
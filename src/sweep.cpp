@@ -0,0 +1,132 @@
+#include "sweep.hpp"
+#include "clusterer.hpp"
+#include "soa.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using std::size_t;
+
+void buildNeighborProfile(const std::vector<Point>& puntos, double eps_max, NeighborProfile& perfil) {
+    perfil.eps_max = eps_max;
+    buildGrid(puntos, eps_max, perfil.grid);
+    const GridIndex& grid = perfil.grid;
+    const size_t n = puntos.size();
+    const size_t celdas = grid.cols * grid.rows;
+    const double eps2 = eps_max * eps_max;
+
+    // Primera pasada: cuántos vecinos tiene cada punto, para dimensionar el CSR.
+    perfil.inicio.assign(n + 1, 0);
+#pragma omp parallel for schedule(dynamic, 16)
+    for (size_t c = 0; c < celdas; ++c) {
+        for (size_t p = grid.inicio[c]; p < grid.inicio[c + 1]; ++p) {
+            // Misma comparación que el llenado, para que cada tramo tenga el tamaño exacto.
+            size_t cuenta = 0;
+            grid.forEachNeighborRange(c, [&](size_t q_ini, size_t q_fin) {
+                for (size_t q = q_ini; q < q_fin; ++q) {
+                    cuenta += q != p && squaredNorm(grid.xs[p] - grid.xs[q], grid.ys[p] - grid.ys[q]) <= eps2;
+                }
+            });
+            perfil.inicio[p + 1] = cuenta;
+        }
+    }
+    for (size_t p = 0; p < n; ++p) {
+        perfil.inicio[p + 1] += perfil.inicio[p];
+    }
+    perfil.distancias.resize(perfil.inicio[n]);
+    perfil.indices.resize(perfil.inicio[n]);
+
+    // Segunda pasada: cada punto llena y ordena su tramo. Los desempates por índice
+    // dejan el perfil igual sin importar el número de hilos.
+#pragma omp parallel
+    {
+        std::vector<std::pair<double, int>> tramo;
+#pragma omp for schedule(dynamic, 16)
+        for (size_t c = 0; c < celdas; ++c) {
+            for (size_t p = grid.inicio[c]; p < grid.inicio[c + 1]; ++p) {
+                tramo.clear();
+                grid.forEachNeighborRange(c, [&](size_t q_ini, size_t q_fin) {
+                    for (size_t q = q_ini; q < q_fin; ++q) {
+                        const double d2 = squaredNorm(grid.xs[p] - grid.xs[q], grid.ys[p] - grid.ys[q]);
+                        if (q != p && d2 <= eps2) {
+                            tramo.emplace_back(d2, static_cast<int>(q));
+                        }
+                    }
+                });
+                std::sort(tramo.begin(), tramo.end());
+                size_t k = perfil.inicio[p];
+                for (const auto& [d2, q] : tramo) {
+                    perfil.distancias[k] = d2;
+                    perfil.indices[k] = q;
+                    ++k;
+                }
+            }
+        }
+    }
+}
+
+std::vector<SweepResult> sweepLabels(const NeighborProfile& perfil,
+                                     const std::vector<double>& epsilons,
+                                     const std::vector<int>& mins,
+                                     std::vector<std::int8_t>* etiquetas) {
+    const size_t n = perfil.size();
+    const GridIndex& grid = perfil.grid;
+    std::vector<SweepResult> resultados;
+    std::vector<char> es_core(n);
+
+    for (double epsilon : epsilons) {
+        if (epsilon > perfil.eps_max) {
+            continue;
+        }
+        const double eps2 = epsilon * epsilon;
+        for (int min_samples : mins) {
+            const double inicio = omp_get_wtime();
+            SweepResult r;
+            r.epsilon = epsilon;
+            r.min_samples = min_samples;
+            std::int8_t* salida = nullptr;
+            if (etiquetas != nullptr) {
+                etiquetas->resize(etiquetas->size() + n);
+                salida = etiquetas->data() + etiquetas->size() - n;
+            }
+
+            // Core: el vecino número min_samples (o p mismo si min_samples <= 0) está
+            // dentro de eps. Como las distancias están ordenadas basta una lectura.
+            size_t cores = 0;
+#pragma omp parallel for schedule(static) reduction(+ : cores)
+            for (size_t p = 0; p < n; ++p) {
+                const size_t k = min_samples > 0 ? static_cast<size_t>(min_samples) : 0;
+                const size_t vecinos = perfil.inicio[p + 1] - perfil.inicio[p];
+                es_core[p] = k == 0 || (k <= vecinos && perfil.distancias[perfil.inicio[p] + k - 1] <= eps2);
+                cores += es_core[p];
+            }
+
+            size_t frontera = 0;
+#pragma omp parallel for schedule(static) reduction(+ : frontera)
+            for (size_t p = 0; p < n; ++p) {
+                int label = es_core[p] ? CORE1 : NOISE;
+                for (size_t k = perfil.inicio[p]; label == NOISE && k < perfil.inicio[p + 1] &&
+                                                  perfil.distancias[k] <= eps2;
+                     ++k) {
+                    if (es_core[static_cast<size_t>(perfil.indices[k])]) {
+                        label = CORE2;
+                    }
+                }
+                frontera += label == CORE2;
+                if (salida != nullptr) {
+                    salida[grid.orden[p]] = static_cast<std::int8_t>(label);
+                }
+            }
+
+            r.cores = cores;
+            r.frontera = frontera;
+            r.ruido = n - cores - frontera;
+            r.tiempo = omp_get_wtime() - inicio;
+            resultados.push_back(r);
+        }
+    }
+    return resultados;
+}
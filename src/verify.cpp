@@ -0,0 +1,570 @@
+#include "verify.hpp"
+#include "approx.hpp"
+#include "autotune.hpp"
+#include "dbscan_nd.hpp"
+#include "generate.hpp"
+#include "io.hpp"
+#include "outofcore.hpp"
+#include "soa.hpp"
+#include "stream.hpp"
+#include "sweep.hpp"
+
+#include <unistd.h>
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <set>
+#include <unordered_map>
+
+using std::size_t;
+
+namespace {
+
+constexpr int REPETICIONES = 3;
+
+// Margen absoluto de una regresión: en los casos de pocos milisegundos el ruido del
+// sistema supera cualquier fracción razonable del tiempo.
+constexpr double HOLGURA = 0.002;
+
+// Bloque de P2 y tareas que no divide a ningún tamaño de caso: deja mosaicos
+// incompletos al final de cada fila.
+constexpr size_t BLOQUE_PEQUENO = 37;
+
+// Lote de inserción del motor incremental: muchos lotes pequeños ejercitan el
+// reetiquetado de vecindarios que ya tenían puntos.
+constexpr size_t LOTE_STREAM = 97;
+
+bool usesBlockSize(Engine engine) {
+    return engine == Engine::ParallelDivided || engine == Engine::ParallelTasks;
+}
+
+// Mínimo de varias repeticiones de f().
+template <typename F>
+double bestOf(F&& f) {
+    double mejor = 0.0;
+    for (int r = 0; r < REPETICIONES; ++r) {
+        const double inicio = omp_get_wtime();
+        f();
+        const double tiempo = omp_get_wtime() - inicio;
+        mejor = r == 0 ? tiempo : std::min(mejor, tiempo);
+    }
+    return mejor;
+}
+
+// Inserta `puntos` en lotes de `lote` y devuelve las etiquetas de los puntos activos.
+std::vector<Point> streamed(const std::vector<Point>& puntos, double epsilon, int min_samples, size_t lote,
+                            size_t ventana) {
+    StreamingDBSCAN stream(epsilon, min_samples, ventana);
+    std::vector<Point> parte;
+    for (size_t inicio = 0; inicio < puntos.size(); inicio += lote) {
+        const size_t fin = std::min(puntos.size(), inicio + lote);
+        parte.assign(puntos.begin() + static_cast<std::ptrdiff_t>(inicio), puntos.begin() + static_cast<std::ptrdiff_t>(fin));
+        stream.insert(parte);
+    }
+    return stream.snapshot();
+}
+
+size_t countMismatchesN(const std::vector<Point>& referencia, const std::vector<int>& labels) {
+    if (referencia.size() != labels.size()) {
+        return std::max(referencia.size(), labels.size());
+    }
+    size_t diferencias = 0;
+    for (size_t i = 0; i < labels.size(); ++i) {
+        diferencias += labels[i] != referencia[i].label;
+    }
+    return diferencias;
+}
+
+std::vector<Point> generated(Distribution dist, size_t count, std::uint64_t seed, int centros, double desviacion) {
+    GeneratorOptions opciones;
+    opciones.dist = dist;
+    opciones.count = count;
+    opciones.seed = seed;
+    opciones.centros = centros;
+    opciones.desviacion = desviacion;
+    return generatePoints(opciones);
+}
+
+// Grilla lado x lado con separación `paso` desde el origen.
+std::vector<Point> lattice(size_t lado, double paso) {
+    std::vector<Point> puntos;
+    puntos.reserve(lado * lado);
+    for (size_t i = 0; i < lado; ++i) {
+        for (size_t j = 0; j < lado; ++j) {
+            Point p;
+            p.x = static_cast<double>(i) * paso;
+            p.y = static_cast<double>(j) * paso;
+            puntos.push_back(p);
+        }
+    }
+    return puntos;
+}
+
+size_t latticeSide(size_t count) {
+    size_t lado = 1;
+    while ((lado + 1) * (lado + 1) <= count) {
+        ++lado;
+    }
+    return lado;
+}
+
+// Clusters de referencia sin grilla ni union-find: BFS sobre los cores de `etiquetados`
+// (etiquetas de la corrida serial) con los vecinos buscados en una ventana de x
+// ordenada. Los componentes se recorren desde el core de menor índice, así que se
+// numeran como en assignClusters, y cada frontera toma el cluster de su core vecino
+// de menor índice.
+std::vector<int> referenceClusters(const std::vector<Point>& etiquetados, double epsilon) {
+    const size_t n = etiquetados.size();
+    const double eps2 = epsilon * epsilon;
+    const double ancho = epsilon * (1.0 + 1e-9);
+    std::vector<size_t> por_x(n);
+    for (size_t i = 0; i < n; ++i) {
+        por_x[i] = i;
+    }
+    std::stable_sort(por_x.begin(), por_x.end(),
+                     [&](size_t a, size_t b) { return etiquetados[a].x < etiquetados[b].x; });
+    std::vector<size_t> posicion(n);
+    for (size_t k = 0; k < n; ++k) {
+        posicion[por_x[k]] = k;
+    }
+    // Llama a f(j) por cada core j a distancia <= epsilon de i.
+    const auto coresVecinos = [&](size_t i, auto&& f) {
+        const Point& p = etiquetados[i];
+        for (size_t k = posicion[i] + 1; k < n && etiquetados[por_x[k]].x - p.x <= ancho; ++k) {
+            const Point& q = etiquetados[por_x[k]];
+            if (q.label == CORE1 && squaredNorm(p.x - q.x, p.y - q.y) <= eps2) {
+                f(por_x[k]);
+            }
+        }
+        for (size_t k = posicion[i]; k-- > 0 && p.x - etiquetados[por_x[k]].x <= ancho;) {
+            const Point& q = etiquetados[por_x[k]];
+            if (q.label == CORE1 && squaredNorm(p.x - q.x, p.y - q.y) <= eps2) {
+                f(por_x[k]);
+            }
+        }
+    };
+
+    std::vector<int> clusters(n, NOISE);
+    std::vector<size_t> pendientes;
+    int siguiente = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (etiquetados[i].label != CORE1 || clusters[i] != NOISE) {
+            continue;
+        }
+        clusters[i] = siguiente;
+        pendientes.assign(1, i);
+        while (!pendientes.empty()) {
+            const size_t actual = pendientes.back();
+            pendientes.pop_back();
+            coresVecinos(actual, [&](size_t j) {
+                if (clusters[j] == NOISE) {
+                    clusters[j] = siguiente;
+                    pendientes.push_back(j);
+                }
+            });
+        }
+        ++siguiente;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (etiquetados[i].label != CORE2) {
+            continue;
+        }
+        size_t menor = n;
+        coresVecinos(i, [&](size_t j) { menor = std::min(menor, j); });
+        if (menor < n) {
+            clusters[i] = clusters[menor];
+        }
+    }
+    return clusters;
+}
+
+std::string trim(const std::string& texto) {
+    const size_t ini = texto.find_first_not_of(" \t\r");
+    const size_t fin = texto.find_last_not_of(" \t\r");
+    return ini == std::string::npos ? "" : texto.substr(ini, fin - ini + 1);
+}
+
+// Base: "cpu=<modelo>", el tamaño y la semilla de los casos, y una línea
+// "<caso>/<motor>/<hilos>/<curva>[/<bloque>]=<segundos>" por corrida. Devuelve un mapa
+// vacío si no existe, es de otra CPU o se midió con otros casos.
+std::map<std::string, double> loadBaseline(const VerifyOptions& opciones, std::ostream& log) {
+    const std::string& ruta = opciones.base;
+    std::map<std::string, double> tiempos;
+    std::ifstream in(ruta);
+    if (!in) {
+        if (!opciones.actualizar) {
+            log << "Base " << ruta << " no existe; pasa `actualizar` para crearla.\n";
+        }
+        return tiempos;
+    }
+    std::string cpu;
+    size_t puntos = 0;
+    std::uint64_t semilla = 0;
+    std::string linea;
+    try {
+        while (std::getline(in, linea)) {
+            const size_t igual = linea.find('=');
+            if (igual == std::string::npos) {
+                continue;
+            }
+            const std::string clave = trim(linea.substr(0, igual));
+            const std::string valor = trim(linea.substr(igual + 1));
+            if (clave == "cpu") {
+                cpu = valor;
+            } else if (clave == "puntos") {
+                puntos = static_cast<size_t>(std::stoull(valor));
+            } else if (clave == "semilla") {
+                semilla = std::stoull(valor);
+            } else {
+                tiempos[clave] = std::stod(valor);
+            }
+        }
+    } catch (const std::exception&) {
+        log << "Base " << ruta << " ilegible; se ignora.\n";
+        return {};
+    }
+    if (cpu != cpuModel()) {
+        log << "Base " << ruta << " es de otra CPU (" << cpu << "); se ignora.\n";
+        return {};
+    }
+    if (puntos != opciones.count || semilla != opciones.seed) {
+        log << "Base " << ruta << " es de " << puntos << " puntos y semilla " << semilla << "; se ignora.\n";
+        return {};
+    }
+    return tiempos;
+}
+
+bool saveBaseline(const VerifyOptions& opciones, const std::map<std::string, double>& tiempos) {
+    const std::string& ruta = opciones.base;
+    const std::filesystem::path padre = std::filesystem::path(ruta).parent_path();
+    if (!padre.empty()) {
+        std::filesystem::create_directories(padre);
+    }
+    std::ofstream out(ruta);
+    if (!out) {
+        return false;
+    }
+    out << "cpu=" << cpuModel() << '\n'
+        << "puntos=" << opciones.count << '\n'
+        << "semilla=" << opciones.seed << '\n'
+        << std::setprecision(9);
+    for (const auto& [clave, segundos] : tiempos) {
+        out << clave << '=' << segundos << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+}
+
+size_t countMismatches(const std::vector<Point>& a, const std::vector<Point>& b) {
+    if (a.size() != b.size()) {
+        return std::max(a.size(), b.size());
+    }
+    size_t mismatches = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].label != b[i].label) {
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+std::vector<VerifyCase> verifyCases(size_t count, std::uint64_t seed) {
+    std::vector<VerifyCase> casos;
+    const double eps = 0.01;
+
+    // Aleatorios: con eps 0.01 y 20000 puntos el uniforme tiene ~6 vecinos por punto,
+    // así que min_samples 5 deja una mezcla de cores, frontera y ruido.
+    for (Distribution dist : {Distribution::Uniform, Distribution::Blobs, Distribution::Skewed, Distribution::Noise}) {
+        casos.push_back({std::string("aleatorio_") + distributionName(dist),
+                         generated(dist, count, seed, 4, 0.06), eps, 5});
+    }
+
+    casos.push_back({"vacio", {}, eps, 5});
+    casos.push_back({"un_punto", {Point{0.5, 0.5}}, eps, 1});
+
+    // Cada posición aparece exactamente 8 veces: con min_samples 8 un punto sin otros
+    // vecinos queda justo en el umbral.
+    {
+        const size_t copias = 8;
+        const std::vector<Point> base = generated(Distribution::Uniform, std::max<size_t>(count / copias, 1), seed + 1, 1, 0.0);
+        std::vector<Point> puntos;
+        puntos.reserve(base.size() * copias);
+        for (size_t c = 0; c < copias; ++c) {
+            puntos.insert(puntos.end(), base.begin(), base.end());
+        }
+        casos.push_back({"duplicados", std::move(puntos), eps / 4, static_cast<int>(copias)});
+    }
+
+    // Todos en el mismo lugar: una sola celda con todos los puntos y un árbol sin
+    // ningún corte útil. Se acota porque cada punto es vecino de todos.
+    {
+        std::vector<Point> puntos(std::min<size_t>(count, 4000), Point{0.25, 0.75});
+        casos.push_back({"mismo_punto", std::move(puntos), eps, 10});
+    }
+
+    // Separación y eps potencias de dos: x, y, las diferencias y sus cuadrados son
+    // exactos, así que los 4 vecinos de la grilla están exactamente a distancia eps.
+    // Con min_samples 5 el interior es core, los bordes frontera y las esquinas ruido.
+    {
+        const double paso = 1.0 / 128.0;
+        casos.push_back({"borde_eps_exacto", lattice(std::min<size_t>(latticeSide(count), 128), paso), paso, 5});
+    }
+
+    // Separación 0.01 en decimal: las diferencias quedan a unos ulp de eps en uno u
+    // otro sentido, y todos los motores deben resolver cada empate igual.
+    casos.push_back({"borde_eps_redondeo", lattice(latticeSide(count), eps), eps, 5});
+
+    casos.push_back({"cluster_gigante", generated(Distribution::Blobs, count, seed + 2, 1, 0.02), eps, 5});
+    casos.push_back({"todo_ruido", generated(Distribution::Uniform, count, seed + 3, 1, 0.0), 1e-4, 5});
+
+    // Caja envolvente de ancho cero en x.
+    {
+        std::vector<Point> puntos = generated(Distribution::Uniform, count, seed + 4, 1, 0.0);
+        for (Point& p : puntos) {
+            p.x = 0.5;
+        }
+        casos.push_back({"colineales", std::move(puntos), eps / 10, 5});
+    }
+    return casos;
+}
+
+std::string defaultBaselinePath() {
+    const char* entorno = std::getenv("DBSCAN_BASELINE");
+    return entorno != nullptr && *entorno != '\0' ? entorno : "data/results/verify.baseline";
+}
+
+VerifyReport verifyEngines(const VerifyOptions& opciones, std::ostream& log) {
+    VerifyReport reporte;
+
+    std::vector<int> hilos = opciones.hilos;
+    if (hilos.empty()) {
+        const std::set<int> hilos_set = {1, 2, omp_get_max_threads()};
+        hilos.assign(hilos_set.begin(), hilos_set.end());
+    }
+    const std::vector<Engine> engines = {Engine::Serial,        Engine::ParallelFull, Engine::ParallelDivided,
+                                         Engine::ParallelTasks, Engine::Grid,         Engine::KdTree};
+    const std::vector<Curve> curvas = {Curve::Ninguna, Curve::Hilbert};
+
+    const std::map<std::string, double> base =
+        opciones.base.empty() ? std::map<std::string, double>{} : loadBaseline(opciones, log);
+    std::map<std::string, double> medidos;
+
+    // Mide una corrida, la compara con la base y escribe su línea. `tiempo` < 0 = sin tiempo.
+    const auto registrar = [&](const std::string& clave, double tiempo, size_t diferencias) {
+        ++reporte.corridas;
+        log << std::fixed << std::setprecision(6) << "  " << std::left << std::setw(40) << clave << std::right;
+        if (tiempo >= 0.0) {
+            log << ' ' << tiempo << " s";
+            medidos[clave] = tiempo;
+        }
+        if (diferencias > 0) {
+            ++reporte.diferencias;
+            log << "  DIFERENCIAS: " << diferencias;
+        } else if (tiempo < 0.0) {
+            log << " ok";
+        }
+        // Sin `actualizar`, una corrida sin tiempo de referencia no puede mostrar una
+        // regresión: cuenta como falla.
+        if (tiempo >= 0.0 && !opciones.base.empty() && !opciones.actualizar) {
+            const auto it = base.find(clave);
+            if (it == base.end()) {
+                ++reporte.sin_base;
+                log << "  (sin base)";
+            } else if (tiempo > it->second * (1.0 + opciones.umbral) + HOLGURA) {
+                ++reporte.regresiones;
+                log << "  REGRESIÓN: base " << it->second << " s";
+            }
+        }
+        log << '\n';
+    };
+
+    for (VerifyCase& caso : verifyCases(opciones.count, opciones.seed)) {
+        log << std::defaultfloat << caso.nombre << ": " << caso.puntos.size() << " puntos  eps " << caso.epsilon << "  min_samples "
+            << caso.min_samples << '\n';
+
+        Clusterer serial(Engine::Serial, 1);
+        std::vector<Point> referencia = caso.puntos;
+        serial.run(referencia, caso.epsilon, caso.min_samples);
+
+        std::vector<Point> trabajo;
+        std::vector<double> tiempos;
+        for (Engine engine : engines) {
+            const std::vector<size_t> bloques =
+                usesBlockSize(engine) ? std::vector<size_t>{512, BLOQUE_PEQUENO} : std::vector<size_t>{512};
+            for (int h : hilos) {
+                for (Curve curva : curvas) {
+                    for (size_t b : bloques) {
+                        Clusterer clusterer(engine, h, b);
+                        clusterer.setCurve(curva);
+                        tiempos.clear();
+                        for (int r = 0; r < REPETICIONES; ++r) {
+                            trabajo = caso.puntos;
+                            const double inicio = omp_get_wtime();
+                            clusterer.run(trabajo, caso.epsilon, caso.min_samples);
+                            tiempos.push_back(omp_get_wtime() - inicio);
+                        }
+                        std::string clave = caso.nombre + '/' + engineName(engine) + '/' + std::to_string(h) + '/' +
+                                            curveName(curva);
+                        if (usesBlockSize(engine)) {
+                            clave += '/' + std::to_string(b);
+                        }
+                        registrar(clave, *std::min_element(tiempos.begin(), tiempos.end()),
+                                  countMismatches(referencia, trabajo));
+                    }
+                }
+            }
+        }
+
+        // Aproximado con rho = 0 y sin muestreo: las celdas enteras dentro o fuera de
+        // eps no cambian ningún conteo, así que debe ser exacto.
+        {
+            ApproxOptions exacto;
+            exacto.rho = 0.0;
+            exacto.muestra = 0;
+            Workspace ws;
+            for (int h : hilos) {
+                const double tiempo = bestOf([&] {
+                    trabajo = caso.puntos;
+                    dbscan_approx(trabajo, caso.epsilon, caso.min_samples, exacto, h, ws);
+                });
+                registrar(caso.nombre + "/approx/" + std::to_string(h), tiempo, countMismatches(referencia, trabajo));
+            }
+        }
+
+        // El barrido etiqueta desde un perfil de vecinos: otra forma de contar que
+        // también debe coincidir.
+        if (!caso.puntos.empty()) {
+            const double inicio = omp_get_wtime();
+            NeighborProfile perfil;
+            buildNeighborProfile(caso.puntos, caso.epsilon, perfil);
+            std::vector<std::int8_t> etiquetas;
+            sweepLabels(perfil, {caso.epsilon}, {caso.min_samples}, &etiquetas);
+            const double tiempo = omp_get_wtime() - inicio;
+            size_t diferencias = 0;
+            for (size_t i = 0; i < referencia.size(); ++i) {
+                diferencias += etiquetas[i] != referencia[i].label;
+            }
+            registrar(caso.nombre + "/sweep", tiempo, diferencias);
+        }
+
+        // Motor incremental sin ventana, todo de una vez y en lotes pequeños. Con una
+        // ventana de la mitad, los activos al final deben quedar como la corrida serial
+        // sobre esa mitad: ejercita la expiración.
+        for (size_t lote : {caso.puntos.size(), LOTE_STREAM}) {
+            if (lote == 0) {
+                continue;
+            }
+            std::vector<Point> etiquetados;
+            const double tiempo = bestOf([&] { etiquetados = streamed(caso.puntos, caso.epsilon, caso.min_samples, lote, 0); });
+            registrar(caso.nombre + "/stream/" + std::to_string(lote), tiempo, countMismatches(referencia, etiquetados));
+        }
+        if (caso.puntos.size() > 1) {
+            const size_t ventana = caso.puntos.size() / 2;
+            std::vector<Point> ultimos(caso.puntos.end() - static_cast<std::ptrdiff_t>(ventana), caso.puntos.end());
+            serial.run(ultimos, caso.epsilon, caso.min_samples);
+            const std::vector<Point> etiquetados =
+                streamed(caso.puntos, caso.epsilon, caso.min_samples, LOTE_STREAM, ventana);
+            registrar(caso.nombre + "/stream/ventana", -1.0, countMismatches(ultimos, etiquetados));
+        }
+
+        // Plantillas de dbscan_nd.hpp con D = 2: acumulan la distancia en el mismo
+        // orden que squaredNorm, así que deben coincidir punto por punto.
+        {
+            PointSetN<double, 2> conjunto;
+            conjunto.coords.reserve(2 * caso.puntos.size());
+            for (const Point& p : caso.puntos) {
+                conjunto.coords.push_back(p.x);
+                conjunto.coords.push_back(p.y);
+            }
+            Workspace ws;
+            double tiempo = bestOf([&] { dbscanSerialN(conjunto, caso.epsilon, caso.min_samples, ws); });
+            registrar(caso.nombre + "/nd_serial", tiempo, countMismatchesN(referencia, conjunto.labels));
+            for (int h : hilos) {
+                tiempo = bestOf([&] { dbscanParallelFullN(conjunto, caso.epsilon, caso.min_samples, h, ws); });
+                registrar(caso.nombre + "/nd_parallel_full/" + std::to_string(h), tiempo,
+                          countMismatchesN(referencia, conjunto.labels));
+                for (size_t b : {size_t{512}, BLOQUE_PEQUENO}) {
+                    tiempo = bestOf([&] { dbscanParallelDividedN(conjunto, caso.epsilon, caso.min_samples, h, b, ws); });
+                    registrar(caso.nombre + "/nd_parallel_divided/" + std::to_string(h) + '/' + std::to_string(b),
+                              tiempo, countMismatchesN(referencia, conjunto.labels));
+                }
+            }
+        }
+
+        // Fuera de memoria sobre un .bin temporal, con un presupuesto de un cuarto del
+        // caso para forzar varias particiones con halo. Si no cabe (una región densa que
+        // no se puede partir) se repite con el doble hasta cubrir el caso completo.
+        if (!caso.puntos.empty()) {
+            const std::filesystem::path carpeta =
+                std::filesystem::temp_directory_path() / ("dbscan_verify_" + std::to_string(::getpid()));
+            std::filesystem::create_directories(carpeta);
+            const std::string entrada = (carpeta / "entrada.bin").string();
+            const std::string salida = (carpeta / "salida.bin").string();
+            OutOfCoreOptions ooc;
+            ooc.memoria = caso.puntos.size() * OOC_BYTES_POR_PUNTO / 4;
+            ooc.num_threads = hilos.back();
+            ooc.temporal = (carpeta / "particiones").string();
+            size_t diferencias = caso.puntos.size();
+            OutOfCoreResult r;
+            if (writePointsBinary(caso.puntos, entrada, false)) {
+                r = dbscan_out_of_core(entrada, salida, caso.epsilon, caso.min_samples, ooc);
+                while (!r.ok && ooc.memoria < 2 * caso.puntos.size() * OOC_BYTES_POR_PUNTO) {
+                    ooc.memoria *= 2;
+                    log << "  (fuera de memoria: se repite con " << ooc.memoria / 1024 << " KiB)\n";
+                    r = dbscan_out_of_core(entrada, salida, caso.epsilon, caso.min_samples, ooc);
+                }
+                const MappedPoints mapa(salida);
+                const std::int32_t* labels = mapa.labels();
+                if (r.ok && labels != nullptr && mapa.size() == referencia.size()) {
+                    diferencias = 0;
+                    for (size_t i = 0; i < referencia.size(); ++i) {
+                        diferencias += labels[i] != referencia[i].label;
+                    }
+                }
+            }
+            std::error_code error;
+            std::filesystem::remove_all(carpeta, error);
+            registrar(caso.nombre + "/ooc/" + std::to_string(r.particiones), -1.0, diferencias);
+        }
+
+        // Clusters: assignClusters con cada número de hilos contra el BFS de
+        // referencia, ID por ID.
+        const std::vector<int> clusters_ref = referenceClusters(referencia, caso.epsilon);
+        for (int h : hilos) {
+            std::vector<Point> clusters_h = referencia;
+            assignClusters(clusters_h, caso.epsilon, h);
+            size_t diferencias = 0;
+            for (size_t i = 0; i < clusters_h.size(); ++i) {
+                diferencias += clusters_h[i].cluster != clusters_ref[i];
+            }
+            registrar(caso.nombre + "/clusters/" + std::to_string(h), -1.0, diferencias);
+        }
+    }
+
+    log << '\n' << reporte.corridas << " corridas, " << reporte.diferencias << " con diferencias, "
+        << reporte.regresiones << " regresiones";
+    if (reporte.sin_base > 0) {
+        log << ", " << reporte.sin_base << " sin base";
+        if (base.empty()) {
+            log << " (sin base utilizable)";
+        }
+    }
+    log << '\n';
+
+    if (opciones.actualizar && !opciones.base.empty()) {
+        if (saveBaseline(opciones, medidos)) {
+            log << "  -> base guardada en: " << opciones.base << '\n';
+        } else {
+            log << "No se pudo escribir " << opciones.base << ".\n";
+        }
+    }
+    return reporte;
+}